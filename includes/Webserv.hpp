@@ -23,6 +23,7 @@
 #include <cstdlib> // for exit
 #include <cstring> // for strncmp
 #include <ctime>
+#include <deque>
 #include <dirent.h> // for directory listing
 #include <exception>
 #include <fcntl.h>
@@ -33,13 +34,18 @@
 #include <map> // for map
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h> // for TCP_NODELAY
+#include <pthread.h>
+#include <set>
 #include <signal.h>
 #include <sstream>
 #include <stdint.h> // for uint16_t
 #include <string>
 #include <sys/epoll.h>
+#include <sys/sendfile.h> // for sendfile
 #include <sys/socket.h> // for send
 #include <sys/stat.h>
+#include <sys/time.h> // for gettimeofday
 #include <sys/types.h> // for pid_t
 #include <sys/wait.h>  // for waitpid
 #include <unistd.h>    // for pipe, dup2, fork, exec
@@ -49,8 +55,30 @@
  
 enum FileType { ISDIR, ISREG, NOT_FOUND_404, PERMISSION_DENIED_403, FILE_SYSTEM_ERROR_500 };
 enum MaxBody { DEFAULT, INFINITE, SPECIFIED };
+enum RangeStatus { RANGE_NONE, RANGE_SATISFIABLE, RANGE_NOT_SATISFIABLE };
+enum StatusFormat { STATUS_OFF, STATUS_PROMETHEUS, STATUS_BASIC };
 
 #define CHUNK_SIZE 500
 #define CHUNKED_TIMEOUT 10000
+#define CHUNK_LINE_MAX 4096
+#define UPLOAD_HEADER_MAX 8192
+#define UPLOAD_NAME_MAX 200
+#define UPLOAD_BUFFER_SIZE 65536
+#define MAX_BYTE_RANGES 16
+#define STREAM_BUFFER_SIZE 65536
+#define GZIP_COMP_LEVEL 6
+#define GZIP_MIN_LENGTH 20
+#define STREAM_PULLS_PER_EVENT 16
+#define LISTING_BATCH 256
+#define LISTING_CACHE_MAX_BODY 262144
+#define LISTING_CACHE_MAX_BYTES 8388608
+#define LISTING_CACHE_TTL 5
+#define DRAIN_TIMEOUT 30
+#define SLOW_EVENT_MS 50
+#define LOG_BUFFER_SIZE 1048576
+#define LOG_FLUSH_INTERVAL 50
+#define TRACE_EVENTS 65536
+#define TRACE_DETAIL_SIZE 64
+#define TRACE_FILE "webserv.trace.json"
 
 #endif
@@ -12,14 +12,14 @@
 
 #include "CGI.hpp"
 
-CGI::CGI(ClientRequest &request, LocConfig *locConfig)
-    : script_path_(locConfig->getFullPath()) {
-	setEnv("SCRIPT_FILENAME", locConfig->getFullPath());
+CGI::CGI(ClientRequest &request, const LocConfig *locConfig, const std::string &script_path)
+    : script_path_(script_path) {
+	setEnv("SCRIPT_FILENAME", script_path);
 	setEnv("SCRIPT_NAME", "/" + request.path);
 	setEnv("REQUEST_METHOD", request.method);
 	setEnv("QUERY_STRING", request.query);
 	if (request.extension == ".php")
-		setEnv("PHPRC", locConfig->getFullPath().substr(0, locConfig->getFullPath().size() - 11));
+		setEnv("PHPRC", script_path.substr(0, script_path.size() - 11));
 	if (request.method == "POST") {
 		setEnv("CONTENT_TYPE", request.headers["content-type"]);
 		setEnv("CONTENT_LENGTH", request.headers["content-length"]);
@@ -17,6 +17,7 @@
 #include "includes/Types.hpp"
 #include "src/ConfigParser/Structs/Struct.hpp"
 #include "src/Logger/Logger.hpp"
+#include "src/Logger/Tracer.hpp"
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/Utils/ServerUtils.hpp"
 
@@ -29,7 +30,7 @@ class CGI {
 	pid_t pid_;
 
   public:
-	CGI(ClientRequest &request, LocConfig *locConfig);
+	CGI(ClientRequest &request, const LocConfig *locConfig, const std::string &script_path);
 	~CGI(){};
 
 	// ENV
@@ -51,7 +52,8 @@ class CGI {
 
 namespace CGIUtils {
 uint16_t runCGIScript(ClientRequest &req, CGI &cgi);
-uint16_t createCGI(CGI *&cgi, ClientRequest &req, LocConfig *locConfig);
+uint16_t createCGI(CGI *&cgi, ClientRequest &req, const LocConfig *locConfig,
+                   const std::string &script_path);
 } // namespace CGIUtils
 
 #endif
@@ -40,6 +40,7 @@ uint16_t CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 	cgi.setOutputFd(output_pipe[0]);
 
 	// 4. Fork and execute
+	long fork_start = Tracer::enabled() ? Tracer::now() : 0;
 	pid_t pid = fork();
 	cgi.setPid(pid);
 	if (pid == -1) {
@@ -65,6 +66,8 @@ uint16_t CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 
 		// Set alarm for timeout
 		alarm(10);
+		// ignored signals survive execve, the script gets the default back
+		signal(SIGPIPE, SIG_DFL);
 
 		// Execute the CGI script
 		char *argv[] = {(char *)cgi.getInterpreter(), (char *)cgi.getScriptPath(), NULL};
@@ -74,6 +77,9 @@ uint16_t CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 		exit(1);
 	}
 
+	if (fork_start)
+		Tracer::record("cgi fork", "cgi", req.clfd, fork_start, Tracer::now(), cgi.getScriptPath());
+
 	// 5. Parent process - close unused pipe ends first
 	close(input_pipe[0]);
 	close(output_pipe[1]);
@@ -83,7 +89,8 @@ uint16_t CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 
 	// 6. Send POST data if any
 	if (req.method == "POST") {
-		logger.logWithPrefix(Logger::INFO, "CGI", "Handling POST request");
+		TraceSpan span("cgi write", "cgi", req.clfd);
+		LOG_INFO_P(logger, "CGI", "Handling POST request");
 		if (!req.body.empty()) {
 			size_t total_written = 0;
 			while (total_written < req.body.size()) {
@@ -103,7 +110,10 @@ uint16_t CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 
 	// Check if execve failed
 	int status;
+	long wait_start = Tracer::enabled() ? Tracer::now() : 0;
 	pid_t wait_result = waitpid(pid, &status, 0);
+	if (wait_start)
+		Tracer::record("cgi wait", "cgi", req.clfd, wait_start, Tracer::now());
 	if (wait_result > 0) {
 		// Child exited immediately - execve likely failed
 		if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
@@ -128,7 +138,8 @@ uint16_t CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 	return (0);
 }
 
-uint16_t CGIUtils::createCGI(CGI *&cgi, ClientRequest &req, LocConfig *locConfig) {
+uint16_t CGIUtils::createCGI(CGI *&cgi, ClientRequest &req, const LocConfig *locConfig,
+                             const std::string &script_path) {
 	Logger logger;
 	// 1. Validate and construct script path
 	if (req.path.empty() || req.path.find("..") != std::string::npos) {
@@ -137,7 +148,7 @@ uint16_t CGIUtils::createCGI(CGI *&cgi, ClientRequest &req, LocConfig *locConfig
 	}
 
 	// Heap allocated
-	cgi = new CGI(req, locConfig);
+	cgi = new CGI(req, locConfig, script_path);
 	uint16_t exit_code = runCGIScript(req, *cgi);
 	if (exit_code)
 		return (exit_code);
@@ -14,7 +14,7 @@
 // #include "Struct.hpp"
 
 bool ConfigParser::loadConfig(const std::string &filePath, std::vector<ServerConfig> &servers,
-                              std::string &prefix, int log_level) {
+                              MimeTypes &types, std::string &prefix, int log_level) {
 
 	ConfigNode tree;
 	ConfigParser configparser(log_level);
@@ -22,8 +22,13 @@ bool ConfigParser::loadConfig(const std::string &filePath, std::vector<ServerCon
 	if (!configparser.parseTree(filePath, tree))
 		return false;
 
+	// types goes to the caller only with a valid file, a failed reload keeps the old table
 	if (!configparser.convertTreeToStruct(tree, servers, prefix))
 		return false;
+	configparser.types_.build();
+	types = configparser.types_;
+	LOG_DEBUG_P(configparser.logg_, "CONFIG",
+	            su::to_string(types.size()) + " MIME types registered");
 
 	return true;
 }
@@ -43,11 +48,14 @@ bool ConfigParser::parseTree(const std::string &filePath, ConfigNode &childNode)
 		return false;
 	}
 
-	logg_.logWithPrefix(Logger::DEBUG, "CONFIG", "Configuration tree successfully created.");
-	logg_.logWithPrefix(Logger::DEBUG, "CONFIG", "Dumping server tree:");
-	std::ostringstream oss;
-	ConfigParser::printTree(childNode, "", true, oss);
-	logg_.logWithPrefix(Logger::DEBUG, "CONFIG", oss.str());
+	LOG_DEBUG_P(logg_, "CONFIG", "Configuration tree successfully created.");
+	// the dump of a generated config runs to megabytes: only build it when it is written
+	if (logg_.isLevelEnabled(Logger::DEBUG)) {
+		LOG_DEBUG_P(logg_, "CONFIG", "Dumping server tree:");
+		std::ostringstream oss;
+		ConfigParser::printTree(childNode, "", true, oss);
+		LOG_DEBUG_P(logg_, "CONFIG", oss.str());
+	}
 	return true;
 }
 
@@ -105,10 +113,10 @@ bool ConfigParser::parseTreeBlocks(std::ifstream &file, int &line_nb, ConfigNode
 			if (!ConfigParser::validateDirective(childNode, parent))
 				return false;
 
-			if (!parseTreeBlocks(file, line_nb, childNode)) {
+			// parse the block in place rather than copying the whole subtree afterwards
+			if (!parseTreeBlocks(file, line_nb, parent.adopt(childNode))) {
 				return false;
 			}
-			parent.children_.push_back(childNode);
 			continue;
 		}
 
@@ -130,7 +138,7 @@ bool ConfigParser::parseTreeBlocks(std::ifstream &file, int &line_nb, ConfigNode
 			                     statement_start_line);
 			if (!ConfigParser::validateDirective(directive, parent))
 				return false;
-			parent.children_.push_back(directive);
+			parent.adopt(directive);
 			continue;
 		}
 
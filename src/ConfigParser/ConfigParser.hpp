@@ -15,6 +15,7 @@
 
 #include "includes/Webserv.hpp"
 #include "src/Logger/Logger.hpp"
+#include "src/Utils/MimeTypes.hpp"
 #include "src/Utils/StringUtils.hpp"
 
 #ifndef SIZE_MAX
@@ -27,6 +28,7 @@ class ConfigNode;
 class ServerConfig;
 class LocConfig;
 class WebServer;
+struct AccessLogConfig;
 
 class ConfigNode {
 	friend class ConfigParser;
@@ -44,6 +46,29 @@ class ConfigNode {
 	    : name_(name),
 	      args_(args),
 	      line_(line) {}
+
+	void swap(ConfigNode &other) {
+		name_.swap(other.name_);
+		args_.swap(other.args_);
+		children_.swap(other.children_);
+		std::swap(line_, other.line_);
+	}
+
+	// Moves child to the end of children_ and returns it. Growing the vector
+	// swaps the existing subtrees over instead of deep-copying them.
+	ConfigNode &adopt(ConfigNode &child) {
+		if (children_.size() == children_.capacity()) {
+			std::vector<ConfigNode> grown;
+			grown.reserve(children_.empty() ? 4 : children_.size() * 2);
+			grown.resize(children_.size());
+			for (size_t i = 0; i < children_.size(); ++i)
+				grown[i].swap(children_[i]);
+			children_.swap(grown);
+		}
+		children_.push_back(ConfigNode());
+		children_.back().swap(child);
+		return children_.back();
+	}
 };
 
 class ConfigParser {
@@ -72,11 +97,14 @@ class ConfigParser {
 	};
 
 	// PARSING THE CONFIGURATION FILE
-	bool loadConfig(const std::string &filePath, std::vector<ServerConfig> &servers, std::string &prefix, int log_level);
+	bool loadConfig(const std::string &filePath, std::vector<ServerConfig> &servers, MimeTypes &types, std::string &prefix, int log_level);
 
   private:
 	Logger logg_;
 	std::vector<Validity> validDirectives_;
+	std::vector<long> directiveSlots_;  // hash table of indices into validDirectives_
+	std::set<std::string> serverKeys_;  // host:port|name of the servers parsed so far
+	MimeTypes types_;                   // built-in table + types / types_file
 
 	// Core parsing methods - tree
 	bool parseTree(const std::string &filePath, ConfigNode &root);
@@ -92,47 +120,64 @@ class ConfigParser {
 	// Validation methods
 	bool validateDirective(const ConfigNode &node, const ConfigNode &parent);
 	bool validateListen(const ConfigNode &node);
+	bool validateServerName(const ConfigNode &node);
 	bool validateError(const ConfigNode &node);
 	bool validateReturn(const ConfigNode &node);
 	bool validateMethod(const ConfigNode &node);
 	bool validateMaxBody(const ConfigNode &node);
 	bool validateAutoIndex(const ConfigNode &node);
+	bool validateAutoIndexFormat(const ConfigNode &node);
 	bool validateLocation(const ConfigNode &node);
 	bool validateCGI(const ConfigNode &node);
 	bool validateChunk(const ConfigNode &node);
 	bool validateUploadPath(const ConfigNode &node);
 	bool validateRoot(const ConfigNode &node);
 	bool validateIndex(const ConfigNode &node);
+	bool validateOnOff(const ConfigNode &node);
+	bool validateGzipTypes(const ConfigNode &node);
+	bool validateGzipMinLength(const ConfigNode &node);
+	bool validateDefaultType(const ConfigNode &node);
+	bool validateTypesFile(const ConfigNode &node);
+	bool validateMimeEntry(const ConfigNode &node);
+	bool validateAccessLog(const ConfigNode &node);
+	bool validateStubStatus(const ConfigNode &node);
 
 	// utils for validity
 	void initValidDirectives();
+	const Validity *findDirective(const std::string &name) const;
 	static std::vector<std::string> makeVector(const std::string &a, const std::string &b);
 	static bool isValidIPv4(const std::string &ip);
 	static bool isValidUri(const std::string &str);
 	static bool isHttp(const std::string &url);
 	static bool hasOKChar(const std::string &str);
 	static bool unknownCode(uint16_t code);
+	static bool isMimeType(const std::string &type);
+	static bool parseAccessLog(const ConfigNode &node, AccessLogConfig &conf);
 
 	// tree to Struct
 	bool convertTreeToStruct(const ConfigNode &tree, std::vector<ServerConfig> &servers, std::string &prefix);
 
 	// handles the directives for the struct
 	void handleListen(const ConfigNode &node, ServerConfig &server);
+	void handleServerName(const ConfigNode &node, ServerConfig &server);
 	void handleErrorPage(const ConfigNode &node, ServerConfig &server);
+	void handleAccessLog(const ConfigNode &node, ServerConfig &server);
 	void handleRoot(const ConfigNode &node, LocConfig &location, const std::string &prefix);
 	void handleIndex(const ConfigNode &node, LocConfig &location);
 	void handleBodySize(const ConfigNode &node, LocConfig &location);
 	void handleLocationBlock(const ConfigNode &locNode, LocConfig &location, const std::string &prefix);
 	void handleReturn(const ConfigNode &node, LocConfig &location);
 	void handleCGI(const ConfigNode &node, LocConfig &location);
+	void handleGzip(const ConfigNode &node, LocConfig &location);
+	void handleTypes(const ConfigNode &node);
+	bool handleTypesFile(const ConfigNode &node, const std::string &prefix);
 	void handleForInherit(const ConfigNode &node, LocConfig &location, const std::string &prefix);
 	
 	//  struct validation and refinments
 	void inheritGeneralConfig(ServerConfig &server, const LocConfig &forInheritance);
-	void sortLocations(std::vector<LocConfig> &locations);
+	void sortLocations(ServerConfig &server);
 	static bool compareLocationPaths(const LocConfig &a, const LocConfig &b);
-	bool isDuplicateServer(const std::vector<ServerConfig> &servers, const ServerConfig &newServer);
-	bool existentLocationDuplicate(const ServerConfig &server, const LocConfig &location);
+	bool isDuplicateServer(const ServerConfig &newServer);
 	bool baseLocation(ServerConfig &server);
 	void addRootToErrorUri(ServerConfig &server);
 	std::string addPrefix(const std::string &uri, const std::string &prefix_);
@@ -86,6 +86,16 @@ bool ConfigParser::hasOKChar(const std::string &str) {
 	return true;
 }
 
+// type/subtype, e.g. text/html or image/svg+xml
+bool ConfigParser::isMimeType(const std::string &type) {
+	size_t slash = type.find('/');
+	if (slash == std::string::npos || slash == 0 || slash == type.size() - 1 ||
+	    type.find('/', slash + 1) != std::string::npos)
+		return false;
+	return su::to_lower(type).find_first_not_of("abcdefghijklmnopqrstuvwxyz0123456789/+-._") ==
+	       std::string::npos;
+}
+
 // check if URL is HTTP/HTTPS
 bool ConfigParser::isHttp(const std::string &url) {
 	if (url.empty())
@@ -182,9 +192,25 @@ void ConfigParser::printLocationConfig(const LocConfig &loc, std::ostream &os) c
 	if (!loc.upload_path.empty()) {
 		os << "    Upload path: " << loc.upload_path << "\n";
 	}
+	if (loc.uploadOn()) {
+		os << "    Upload: on (max file size "
+		   << (loc.upload_max_file_size ? su::humanReadableBytes(loc.upload_max_file_size)
+		                                : std::string("unlimited"))
+		   << (loc.uploadFsyncOn() ? ", fsync" : "") << ")\n";
+	}
 
-	os << "    Autoindex: " << (loc.autoindex ? "on" : "off") << "\n";
+	os << "    Autoindex: " << (loc.autoindex ? "on" : "off")
+	   << (loc.autoindex_json ? " (json)" : "") << "\n";
 	os << "    Exact match only: " << (loc.exact_match ? "on" : "off") << "\n";
+	os << "    Gzip: " << (loc.gzipOn() ? "on" : "off") << " (static "
+	   << (loc.gzipStaticOn() ? "on" : "off") << ", min length " << loc.getGzipMinLength()
+	   << ")\n";
+	if (!loc.gzip_types.empty())
+		os << "    Gzip types: " << joinArgs(loc.gzip_types) << "\n";
+	if (!loc.default_type.empty())
+		os << "    Default type: " << loc.default_type << "\n";
+	if (loc.serverTimingOn())
+		os << "    Server-Timing: on\n";
 
 	if (!loc.allowed_methods.empty()) {
 		os << "    Allowed methods: ";
@@ -209,7 +235,14 @@ void ConfigParser::printLocationConfig(const LocConfig &loc, std::ostream &os) c
 	}
 }
 void ConfigParser::printServerConfig(const ServerConfig &server, std::ostream &os) const {
-	os << "Server on " << server.getHost() << ":" << server.port << "\n";
+	os << "Server on " << server.getHost() << ":" << server.port
+	   << (server.default_server ? " (default_server)" : "") << "\n";
+	if (!server.server_names.empty()) {
+		os << "  Server names:";
+		for (size_t i = 0; i < server.server_names.size(); ++i)
+			os << " " << server.server_names[i];
+		os << "\n";
+	}
 
 	if (!server.error_pages.empty()) {
 		os << "  Error pages:\n";
@@ -15,6 +15,9 @@
 
 bool ConfigParser::convertTreeToStruct(const ConfigNode &tree, std::vector<ServerConfig> &servers, std::string &prefix) {
 
+	// servers are built in place: copying one drags all its locations along
+	servers.reserve(servers.size() + tree.children_.size());
+
 	for (std::vector<ConfigNode>::const_iterator node = tree.children_.begin();
 		 node != tree.children_.end(); ++node) {
 
@@ -23,44 +26,60 @@ bool ConfigParser::convertTreeToStruct(const ConfigNode &tree, std::vector<Serve
 				return false;
 		}
 
+		else if (node->name_ == "types")
+			handleTypes(*node);
+
+		else if (node->name_ == "types_file") {
+			if (!handleTypesFile(*node, prefix))
+				return false;
+		}
+
 		else if (node->name_ == "server") {
 
-			ServerConfig server;
+			servers.push_back(ServerConfig());
+			ServerConfig &server = servers.back();
 			server.prefix_ = prefix;
+			server.locations.reserve(node->children_.size() + 1);
 			LocConfig forInheritance;
+			std::set<std::string> locationPaths;
 
 			for (std::vector<ConfigNode>::const_iterator child = node->children_.begin();
 				 child != node->children_.end(); ++child) {
 
 				if (child->name_ == "listen")
 					handleListen(*child, server);
+				else if (child->name_ == "server_name")
+					handleServerName(*child, server);
 				else if (child->name_ == "error_page")
 					handleErrorPage(*child, server);
+				else if (child->name_ == "access_log")
+					handleAccessLog(*child, server);
 
 
 				else if (child->name_ == "location") {
-					LocConfig location;
+					server.locations.push_back(LocConfig());
+					LocConfig &location = server.locations.back();
 					location.path = child->args_[0];
 					handleLocationBlock(*child, location, server.prefix_);
 					// check for duplicates locations
-					if (existentLocationDuplicate(server, location)) {
+					if (!locationPaths.insert(location.path).second) {
 						logg_.logWithPrefix(
 							Logger::ERROR, "Configuration file",
 							"Location block already exists for this path: " + child->args_[0] +
 								", line " + su::to_string(child->line_));
 						return false;
 					}
-					server.locations.push_back(location);
 				}
 
 				else
 					handleForInherit(*child, forInheritance, server.prefix_);
 			}
 
-			// check for duplicate host:port combination
-			if (isDuplicateServer(servers, server)) {
+			// check for a server already answering these names on host:port
+			if (isDuplicateServer(server)) {
 				logg_.logWithPrefix(Logger::ERROR, "Configuration file",
-									"Duplicate server configuration for " + server.host + ":" +
+									"Duplicate server configuration (same server_name or "
+									"default_server) for " + server.host + ":" +
 										su::to_string(server.port));
 				return false;
 			}
@@ -70,31 +89,57 @@ bool ConfigParser::convertTreeToStruct(const ConfigNode &tree, std::vector<Serve
 				LocConfig defaultLocation;
 				defaultLocation.path = "/";
 				server.locations.push_back(defaultLocation);
-				logg_.logWithPrefix(Logger::DEBUG, "Config parsing",
+				LOG_DEBUG_P(logg_, "Config parsing",
 									"Base/default location block created for" + server.host + ":" +
 										su::to_string(server.port));
 			}
 
 			inheritGeneralConfig(server, forInheritance);
-			sortLocations(server.locations);
+			sortLocations(server);
 
-			logg_.logWithPrefix(Logger::INFO, "Config parsing",
+			LOG_INFO_P(logg_, "Config parsing",
 								"Parsed server block on " + server.host + ":" +
 									su::to_string(server.port) + " with " +
 									su::to_string(server.locations.size()) + " location(s).");
 
-			logg_.logWithPrefix(Logger::DEBUG, "Config parsing", "Dumping server config");
-			std::ostringstream oss;
-			printServerConfig(server, oss);
-			logg_.logWithPrefix(Logger::DEBUG, "Config parsing", oss.str());
-
-			servers.push_back(server);
+			if (logg_.isLevelEnabled(Logger::DEBUG)) {
+				LOG_DEBUG_P(logg_, "Config parsing", "Dumping server config");
+				std::ostringstream oss;
+				printServerConfig(server, oss);
+				LOG_DEBUG_P(logg_, "Config parsing", oss.str());
+			}
 		}
 	}
 	return true;
 }
 
 
+////////////////////
+// HTTP-LEVEL DIRECTIVE HANDLERS
+////
+
+// TYPES block: "mime/type ext1 ext2;" entries, overriding the built-in table
+void ConfigParser::handleTypes(const ConfigNode &node) {
+	for (std::vector<ConfigNode>::const_iterator entry = node.children_.begin();
+		 entry != node.children_.end(); ++entry) {
+		for (size_t i = 0; i < entry->args_.size(); ++i)
+			types_.add(entry->args_[i], su::to_lower(entry->name_));
+	}
+}
+
+// TYPES_FILE: mime.types file (Apache or nginx format)
+bool ConfigParser::handleTypesFile(const ConfigNode &node, const std::string &prefix) {
+	std::string path = addPrefix(node.args_[0], prefix);
+	if (!types_.loadFile(path)) {
+		logg_.logWithPrefix(Logger::ERROR, "Configuration file",
+							"Could not read types_file " + path + " on line " +
+								su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+
 ////////////////////
 // SERVER-LEVEL DIRECTIVE HANDLERS
 ////
@@ -110,6 +155,17 @@ void ConfigParser::handleListen(const ConfigNode &node, ServerConfig &server) {
 		server.port = std::atoi(value.substr(colonPos + 1).c_str());
 	} else
 		server.port = std::atoi(value.c_str());
+	server.default_server = (node.args_.size() == 2);
+}
+
+// SERVER NAMES - matched case-insensitively against the Host header
+void ConfigParser::handleServerName(const ConfigNode &node, ServerConfig &server) {
+	for (size_t i = 0; i < node.args_.size(); ++i) {
+		std::string name = node.args_[i];
+		for (size_t j = 0; j < name.size(); ++j)
+			name[j] = std::tolower(static_cast<unsigned char>(name[j]));
+		server.server_names.push_back(name);
+	}
 }
 
 // ERROR PAGES - map code - html
@@ -121,7 +177,14 @@ void ConfigParser::handleErrorPage(const ConfigNode &node, ServerConfig &server)
 	}
 }
 
-// Root, Methods, Upload path, autoindex, CGI and max body size can be defined server level -> for inheritance
+// ACCESS LOG - validated already, relative paths are resolved like error pages
+void ConfigParser::handleAccessLog(const ConfigNode &node, ServerConfig &server) {
+	parseAccessLog(node, server.access_log_conf);
+	if (!server.access_log_conf.path.empty())
+		server.access_log_conf.path = addPrefix(server.access_log_conf.path, server.getPrefix());
+}
+
+// Root, Methods, Upload path, upload, autoindex, CGI, gzip, server_timing and max body size can be defined server level -> for inheritance
 void ConfigParser::handleForInherit(const ConfigNode &node, LocConfig &location, const std::string &prefix) {
 	if (node.name_ == "root")
 		handleRoot(node, location, prefix);
@@ -136,8 +199,18 @@ void ConfigParser::handleForInherit(const ConfigNode &node, LocConfig &location,
 		location.index = node.args_[0];
 	else if (node.name_ == "cgi_ext")
 		handleCGI(node, location);
-	else if (node.name_ == "client_max_body_size")
+	else if (node.name_ == "client_max_body_size" || node.name_ == "upload_max_file_size")
 		handleBodySize(node, location);
+	else if (su::starts_with(node.name_, "gzip"))
+		handleGzip(node, location);
+	else if (node.name_ == "default_type")
+		location.default_type = node.args_[0];
+	else if (node.name_ == "server_timing")
+		location.server_timing = (node.args_[0] == "on");
+	else if (node.name_ == "upload")
+		location.upload = (node.args_[0] == "on");
+	else if (node.name_ == "upload_fsync")
+		location.upload_fsync = (node.args_[0] == "on");
 }
 
 
@@ -154,16 +227,35 @@ void ConfigParser::handleLocationBlock(const ConfigNode &locNode, LocConfig &loc
 			handleRoot(*node, location, prefix);
 		else if (node->name_ == "autoindex")
 			location.autoindex = (node->args_[0] == "on");
+		else if (node->name_ == "autoindex_format")
+			location.autoindex_json = (node->args_[0] == "json");
+		else if (node->name_ == "stub_status")
+			location.stub_status = (!node->args_.empty() && node->args_[0] == "basic")
+			                           ? STATUS_BASIC
+			                           : STATUS_PROMETHEUS;
 		else if (node->name_ == "index")
 			handleIndex(*node, location);
-		else if (node->name_ == "upload_path")
-			location.upload_path = addPrefix(node->args_[0], prefix);
+		else if (node->name_ == "upload_path") {
+			std::string path = (su::back(node->args_[0]) == '/') ? node->args_[0]
+			                                                     : node->args_[0] + "/";
+			location.upload_path = addPrefix(path, prefix);
+		}
 		else if (node->name_ == "return")
 			handleReturn(*node, location);
 		else if (node->name_ == "cgi_ext")
 			handleCGI(*node, location);
-		else if (node->name_ == "client_max_body_size")
+		else if (node->name_ == "client_max_body_size" || node->name_ == "upload_max_file_size")
 			handleBodySize(*node, location);
+		else if (su::starts_with(node->name_, "gzip"))
+			handleGzip(*node, location);
+		else if (node->name_ == "default_type")
+			location.default_type = node->args_[0];
+		else if (node->name_ == "server_timing")
+			location.server_timing = (node->args_[0] == "on");
+		else if (node->name_ == "upload")
+			location.upload = (node->args_[0] == "on");
+		else if (node->name_ == "upload_fsync")
+			location.upload_fsync = (node->args_[0] == "on");
 	}
 }
 
@@ -214,7 +306,22 @@ void ConfigParser::handleCGI(const ConfigNode &node, LocConfig &location) {
 	}
 }
 
-// MAX BODY SIZE
+// GZIP, GZIP_STATIC, GZIP_TYPES, GZIP_MIN_LENGTH
+void ConfigParser::handleGzip(const ConfigNode &node, LocConfig &location) {
+	if (node.name_ == "gzip")
+		location.gzip = (node.args_[0] == "on");
+	else if (node.name_ == "gzip_static")
+		location.gzip_static = (node.args_[0] == "on");
+	else if (node.name_ == "gzip_types") {
+		location.gzip_types.clear();
+		for (size_t i = 0; i < node.args_.size(); ++i)
+			location.gzip_types.push_back(su::to_lower(node.args_[i]));
+	}
+	else if (node.name_ == "gzip_min_length")
+		location.gzip_min_length = std::atol(node.args_[0].c_str());
+}
+
+// MAX BODY SIZE, UPLOAD MAX FILE SIZE
 void ConfigParser::handleBodySize(const ConfigNode &node, LocConfig &location) {
 	// megabits or giga
 	int factor = 1;
@@ -233,6 +340,11 @@ void ConfigParser::handleBodySize(const ConfigNode &node, LocConfig &location) {
 	std::istringstream iss(maxBody);
 	size_t maxBodyFactor;
 	iss >> maxBodyFactor;
+	if (node.name_ == "upload_max_file_size") {
+		location.upload_max_file_size = maxBodyFactor * factor;
+		location.upload_max_set = true;
+		return;
+	}
 	location.client_max_body_size = maxBodyFactor * factor;
 	location.body_size_set = true;
 }
@@ -276,39 +388,64 @@ void ConfigParser::inheritGeneralConfig(ServerConfig &server, const LocConfig &f
 			loc.client_max_body_size = forInheritance.client_max_body_size;
 			loc.body_size_set = true;
 		}
+		// Inherit gzip settings if not specified
+		if (loc.gzip == -1)
+			loc.gzip = forInheritance.gzip;
+		if (loc.gzip_static == -1)
+			loc.gzip_static = forInheritance.gzip_static;
+		if (loc.gzip_min_length == -1)
+			loc.gzip_min_length = forInheritance.gzip_min_length;
+		if (loc.gzip_types.empty())
+			loc.gzip_types = forInheritance.gzip_types;
+		// Inherit default type if not specified
+		if (loc.default_type.empty())
+			loc.default_type = forInheritance.default_type;
+		// Inherit Server-Timing header if not specified
+		if (loc.server_timing == -1)
+			loc.server_timing = forInheritance.server_timing;
+		// Inherit native upload settings if not specified
+		if (loc.upload == -1)
+			loc.upload = forInheritance.upload;
+		if (loc.upload_fsync == -1)
+			loc.upload_fsync = forInheritance.upload_fsync;
+		if (forInheritance.upload_max_set && !loc.upload_max_set) {
+			loc.upload_max_file_size = forInheritance.upload_max_file_size;
+			loc.upload_max_set = true;
+		}
 		// Inherit index only in base / default location
 		if (loc.path == "/" && loc.index.empty())
 			loc.index = forInheritance.index;
 	}
 }
 
-// HOST:SERVER dupliactes -> not accepted
-bool ConfigParser::isDuplicateServer(const std::vector<ServerConfig> &servers,
-									 const ServerConfig &newServer) {
-	for (std::vector<ServerConfig>::const_iterator it = servers.begin(); it != servers.end();
-		 ++it) {
-		if (it->host == newServer.host && it->port == newServer.port) {
-			return true;
-		}
-	}
-	return false;
-}
-
-// LOCATION PATH dupliactes -> not accepted
-bool ConfigParser::existentLocationDuplicate(const ServerConfig &server,
-											 const LocConfig &location) {
-	for (size_t i = 0; i < server.locations.size(); ++i) {
-		LocConfig loc = server.locations[i];
-		if (loc.path == location.path)
+// HOST:PORT shared by several servers -> only with distinct server_names,
+// at most one default_server and at most one server without names.
+// Every server leaves its keys in serverKeys_, so each check is a few lookups
+// instead of a pass over all the servers parsed so far.
+bool ConfigParser::isDuplicateServer(const ServerConfig &newServer) {
+	std::string listen = newServer.host + ":" + su::to_string(newServer.port);
+	std::vector<std::string> keys;
+	if (newServer.server_names.empty())
+		keys.push_back(listen + "|");
+	for (size_t i = 0; i < newServer.server_names.size(); ++i)
+		keys.push_back(listen + "|" + newServer.server_names[i]);
+	if (newServer.default_server)
+		keys.push_back(listen + "#default");
+
+	for (size_t i = 0; i < keys.size(); ++i) {
+		if (serverKeys_.count(keys[i]))
 			return true;
 	}
+	serverKeys_.insert(keys.begin(), keys.end());
 	return false;
 }
 
 
-// SORT LOCATIONS by path length (longest first for proper nginx-style matching)
-void ConfigParser::sortLocations(std::vector<LocConfig> &locations) {
-	std::sort(locations.begin(), locations.end(), compareLocationPaths);
+// SORT LOCATIONS by path length (longest first, for the debug dump) and
+// compile them into the server's location trie
+void ConfigParser::sortLocations(ServerConfig &server) {
+	std::sort(server.locations.begin(), server.locations.end(), compareLocationPaths);
+	server.indexLocations();
 }
 bool ConfigParser::compareLocationPaths(const LocConfig &a, const LocConfig &b) {
 	if (a.path.length() != b.path.length())
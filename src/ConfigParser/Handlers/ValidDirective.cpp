@@ -11,6 +11,7 @@
 /* ************************************************************************** */
 
 #include "src/ConfigParser/ConfigParser.hpp"
+#include "src/ConfigParser/Structs/Struct.hpp"
 
 // Constructor - initialize valid directives
 ConfigParser::ConfigParser(int log_level)
@@ -32,87 +33,143 @@ void ConfigParser::initValidDirectives() {
 	    Validity("http", std::vector<std::string>(1, "main"), true, 0, 0, NULL));
 	validDirectives_.push_back(
 	    Validity("server", std::vector<std::string>(1, "http"), true, 0, 0, NULL));
+	// http only level: MIME registry shared by all servers
+	validDirectives_.push_back(
+	    Validity("types", std::vector<std::string>(1, "http"), true, 0, 0, NULL));
+	validDirectives_.push_back(Validity("types_file", std::vector<std::string>(1, "http"), true, 1,
+	                                    1, &ConfigParser::validateTypesFile));
 	// server only level
 	validDirectives_.push_back(Validity("listen", std::vector<std::string>(1, "server"), false, 1,
-	                                    1, &ConfigParser::validateListen));
+	                                    2, &ConfigParser::validateListen));
+	validDirectives_.push_back(Validity("server_name", std::vector<std::string>(1, "server"), true,
+	                                    1, SIZE_MAX, &ConfigParser::validateServerName));
 	validDirectives_.push_back(Validity("error_page", std::vector<std::string>(1, "server"), true,
 	                                    2, SIZE_MAX, &ConfigParser::validateError));
 	validDirectives_.push_back(Validity("client_max_body_size", makeVector("server", "location"),
 	                                    false, 1, 1, &ConfigParser::validateMaxBody));
+	validDirectives_.push_back(Validity("access_log", std::vector<std::string>(1, "server"), false,
+	                                    1, 5, &ConfigParser::validateAccessLog));
 	validDirectives_.push_back(Validity("location", std::vector<std::string>(1, "server"), true, 1,
 	                                    1, &ConfigParser::validateLocation));
 	// server or location level  (will be inherited in the locations if not set in the location)
 	validDirectives_.push_back(Validity("root", makeVector("server", "location"), false, 1, 1,
 	                                    &ConfigParser::validateRoot));
 	validDirectives_.push_back(Validity("allowed_methods", makeVector("server", "location"), false,
-	                                    1, 3, &ConfigParser::validateMethod));
+	                                    1, 4, &ConfigParser::validateMethod));
 	validDirectives_.push_back(Validity("upload_path", makeVector("server", "location"), false, 1,
 	                                    1, &ConfigParser::validateUploadPath));
 	validDirectives_.push_back(Validity("cgi_ext", makeVector("server", "location"), false, 2,
 	                                    SIZE_MAX, &ConfigParser::validateCGI));
 	validDirectives_.push_back(Validity("index", makeVector("server", "location"), false, 1, 1,
 	                                    &ConfigParser::validateIndex));
+	validDirectives_.push_back(Validity("gzip", makeVector("server", "location"), false, 1, 1,
+	                                    &ConfigParser::validateOnOff));
+	validDirectives_.push_back(Validity("gzip_static", makeVector("server", "location"), false, 1,
+	                                    1, &ConfigParser::validateOnOff));
+	validDirectives_.push_back(Validity("gzip_types", makeVector("server", "location"), false, 1,
+	                                    SIZE_MAX, &ConfigParser::validateGzipTypes));
+	validDirectives_.push_back(Validity("gzip_min_length", makeVector("server", "location"), false,
+	                                    1, 1, &ConfigParser::validateGzipMinLength));
+	validDirectives_.push_back(Validity("default_type", makeVector("server", "location"), false,
+	                                    1, 1, &ConfigParser::validateDefaultType));
+	validDirectives_.push_back(Validity("server_timing", makeVector("server", "location"), false,
+	                                    1, 1, &ConfigParser::validateOnOff));
+	validDirectives_.push_back(Validity("upload", makeVector("server", "location"), false, 1, 1,
+	                                    &ConfigParser::validateOnOff));
+	validDirectives_.push_back(Validity("upload_max_file_size", makeVector("server", "location"),
+	                                    false, 1, 1, &ConfigParser::validateMaxBody));
+	validDirectives_.push_back(Validity("upload_fsync", makeVector("server", "location"), false,
+	                                    1, 1, &ConfigParser::validateOnOff));
 	// location only level
 	validDirectives_.push_back(Validity("autoindex", std::vector<std::string>(1, "location"), false,
 	                                    1, 1, &ConfigParser::validateAutoIndex));
+	validDirectives_.push_back(Validity("autoindex_format", std::vector<std::string>(1, "location"),
+	                                    false, 1, 1, &ConfigParser::validateAutoIndexFormat));
 	validDirectives_.push_back(Validity("return", std::vector<std::string>(1, "location"), false, 1,
 	                                    2, &ConfigParser::validateReturn));
+	validDirectives_.push_back(Validity("stub_status", std::vector<std::string>(1, "location"),
+	                                    false, 0, 1, &ConfigParser::validateStubStatus));
+
+	// index the table by name: generated configs validate hundreds of thousands of nodes
+	size_t capacity = 16;
+	while (capacity < validDirectives_.size() * 2)
+		capacity *= 2;
+	directiveSlots_.assign(capacity, -1);
+	for (size_t i = 0; i < validDirectives_.size(); ++i) {
+		size_t slot = su::hash(validDirectives_[i].name_) & (capacity - 1);
+		while (directiveSlots_[slot] != -1)
+			slot = (slot + 1) & (capacity - 1);
+		directiveSlots_[slot] = i;
+	}
+}
+
+const ConfigParser::Validity *ConfigParser::findDirective(const std::string &name) const {
+	size_t mask = directiveSlots_.size() - 1;
+	for (size_t slot = su::hash(name) & mask; directiveSlots_[slot] != -1;
+	     slot = (slot + 1) & mask) {
+		const Validity &v = validDirectives_[directiveSlots_[slot]];
+		if (v.name_ == name)
+			return &v;
+	}
+	return NULL;
 }
 
 // CHECK NB OF ARGS, CONTEXT, DUPLICATES, TAILORED VALIDITY FUNCTION
 bool ConfigParser::validateDirective(const ConfigNode &node, const ConfigNode &parent) {
 
-	for (std::vector<Validity>::const_iterator it = validDirectives_.begin();
-	     it != validDirectives_.end(); ++it) {
-		if (it->name_ == node.name_) {
-			bool contextOK = false;
-			for (size_t i = 0; i < it->contexts_.size(); ++i) {
-				if (parent.name_ == it->contexts_[i]) {
-					contextOK = true;
-					break;
-				}
-			}
-			if (!contextOK) {
-				logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-				                    "Directive '" + node.name_ + "' is not allowed in context '" +
-				                        parent.name_ + "' on line " + su::to_string(node.line_));
-				return false;
-			}
-			if (!it->repeatOK_) {
-				int count = 0;
-				for (size_t i = 0; i < parent.children_.size(); ++i) {
-					if (parent.children_[i].name_ == node.name_) {
-						count++;
-					}
-				}
-				if (count > 0) {
-					logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-					                    "Directive '" + node.name_ +
-					                        "' cannot be repeated in context '" + parent.name_ +
-					                        "' on line " + su::to_string(node.line_));
-					return false;
-				}
-			}
-			if (node.args_.size() < it->min_args_ || node.args_.size() > it->max_args_) {
-				logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-				                    "Directive '" + node.name_ + "' expects between " +
-				                        su::to_string(it->min_args_) + " and " +
-				                        su::to_string(it->max_args_) + " arguments, but got " +
-				                        su::to_string(node.args_.size()) + " on line " +
-				                        su::to_string(node.line_));
-				return false;
-			}
-			if (it->valid_f_ != NULL) {
-				if (!(this->*(it->valid_f_))(node))
-					return false;
+	// inside types {}, every entry is "mime/type ext1 [ext2 ...];"
+	if (parent.name_ == "types")
+		return validateMimeEntry(node);
+
+	const Validity *dir = findDirective(node.name_);
+	if (dir == NULL) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "Unknown directive: '" + node.name_ + "' on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+	bool contextOK = false;
+	for (size_t i = 0; i < dir->contexts_.size(); ++i) {
+		if (parent.name_ == dir->contexts_[i]) {
+			contextOK = true;
+			break;
+		}
+	}
+	if (!contextOK) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "Directive '" + node.name_ + "' is not allowed in context '" +
+		                        parent.name_ + "' on line " + su::to_string(node.line_));
+		return false;
+	}
+	if (!dir->repeatOK_) {
+		int count = 0;
+		for (size_t i = 0; i < parent.children_.size(); ++i) {
+			if (parent.children_[i].name_ == node.name_) {
+				count++;
 			}
-			return true;
+		}
+		if (count > 0) {
+			logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+			                    "Directive '" + node.name_ +
+			                        "' cannot be repeated in context '" + parent.name_ +
+			                        "' on line " + su::to_string(node.line_));
+			return false;
 		}
 	}
-	logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-	                    "Unknown directive: '" + node.name_ + "' on line " +
-	                        su::to_string(node.line_));
-	return false;
+	if (node.args_.size() < dir->min_args_ || node.args_.size() > dir->max_args_) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "Directive '" + node.name_ + "' expects between " +
+		                        su::to_string(dir->min_args_) + " and " +
+		                        su::to_string(dir->max_args_) + " arguments, but got " +
+		                        su::to_string(node.args_.size()) + " on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+	if (dir->valid_f_ != NULL) {
+		if (!(this->*(dir->valid_f_))(node))
+			return false;
+	}
+	return true;
 }
 
 // LISTEN: ipv4:port, or :port, or port ()
@@ -121,6 +178,13 @@ bool ConfigParser::validateListen(const ConfigNode &node) {
 	std::string host;
 	std::string portStr;
 
+	if (node.args_.size() == 2 && node.args_[1] != "default_server") {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "Invalid 'listen' parameter: " + node.args_[1] + " on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+
 	// handles ":port"
 	if (value[0] == ':')
 		portStr = value.substr(1);
@@ -162,6 +226,32 @@ bool ConfigParser::validateListen(const ConfigNode &node) {
 	return true;
 }
 
+// SERVER_NAME: host names, "*.example.com", ".example.com" or "www.example.*"
+bool ConfigParser::validateServerName(const ConfigNode &node) {
+	for (size_t i = 0; i < node.args_.size(); ++i) {
+		const std::string &name = node.args_[i];
+		std::string core = name;
+		if (core.compare(0, 2, "*.") == 0)
+			core = core.substr(2);
+		else if (core.size() > 2 && core.compare(core.size() - 2, 2, ".*") == 0)
+			core = core.substr(0, core.size() - 2);
+		else if (!core.empty() && core[0] == '.')
+			core = core.substr(1);
+		bool ok = !core.empty() && core[0] != '.' && su::back(core) != '.';
+		for (size_t j = 0; ok && j < core.size(); ++j) {
+			unsigned char c = core[j];
+			ok = std::isalnum(c) || c == '-' || c == '_' || (c == '.' && core[j - 1] != '.');
+		}
+		if (!ok) {
+			logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+			                    "Invalid server_name: " + name + " on line " +
+			                        su::to_string(node.line_));
+			return false;
+		}
+	}
+	return true;
+}
+
 // RETURN : 300 - 599. If no code-> one arg (URL or error), otherwise code + uri/url
 bool ConfigParser::validateReturn(const ConfigNode &node) {
 	// 1 arg: url or error code
@@ -228,7 +318,7 @@ bool ConfigParser::validateMaxBody(const ConfigNode &node) {
 	std::string maxBody = node.args_[0];
 	if (maxBody.empty()) {
 		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-		                    "client_max_body_size cannot be empty on line " +
+		                    node.name_ + " cannot be empty on line " +
 		                        su::to_string(node.line_));
 		return false;
 	}
@@ -237,7 +327,7 @@ bool ConfigParser::validateMaxBody(const ConfigNode &node) {
 		maxBody = su::rtrim(maxBody.substr(0, maxBody.size() - 1));
 	if (maxBody.empty()) {
 		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-		                    "client_max_body_size invalid format: '" + node.args_[0] +
+		                    node.name_ + " invalid format: '" + node.args_[0] +
 		                        "' on line " + su::to_string(node.line_));
 		return false;
 	}
@@ -245,13 +335,82 @@ bool ConfigParser::validateMaxBody(const ConfigNode &node) {
 	unsigned int n;
 	if (!(iss >> n) || iss.fail() || !iss.eof()) {
 		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-		                    "client_max_body_size is invalid: '" + node.args_[0] + "' on line " +
+		                    node.name_ + " is invalid: '" + node.args_[0] + "' on line " +
 		                        su::to_string(node.line_));
 		return false;
 	}
 	return true;
 }
 
+// access_log off | path [combined|timing|json] [buffer=64k] [flush=1s] [sample=10]
+bool ConfigParser::validateAccessLog(const ConfigNode &node) {
+	AccessLogConfig conf;
+	if (!parseAccessLog(node, conf)) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "access_log expects 'off' or a path followed by combined|timing|json, "
+		                    "buffer=size, flush=time (ms, s, m) and sample=n, on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+// number with an optional unit suffix, each unit being `scale` times the plain number
+static bool parseScaled(const std::string &value, const char *units, const long *scales,
+                        long &out) {
+	size_t digits = value.find_first_not_of("0123456789");
+	if (digits == std::string::npos)
+		digits = value.size();
+	if (digits == 0 || digits > 9)
+		return false;
+	long n = std::atol(value.substr(0, digits).c_str());
+	if (digits == value.size()) {
+		out = n * scales[0];
+		return true;
+	}
+	std::string unit = value.substr(digits);
+	for (size_t i = 0; units[i]; ++i) {
+		if (unit.size() == 1 && std::tolower(unit[0]) == units[i]) {
+			out = n * scales[i + 1];
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ConfigParser::parseAccessLog(const ConfigNode &node, AccessLogConfig &conf) {
+	static const long sizeScales[] = {1, 1024, 1024 * 1024};
+	static const long timeScales[] = {1000, 1000, 60000}; // a plain number is in seconds
+
+	conf = AccessLogConfig();
+	if (node.args_[0] == "off")
+		return node.args_.size() == 1;
+	conf.path = node.args_[0];
+	for (size_t i = 1; i < node.args_.size(); ++i) {
+		const std::string &arg = node.args_[i];
+		std::string value = arg.substr(arg.find('=') + 1);
+		long n;
+		if (arg == "combined")
+			conf.format = AccessLogConfig::COMBINED;
+		else if (arg == "timing")
+			conf.format = AccessLogConfig::TIMING;
+		else if (arg == "json")
+			conf.format = AccessLogConfig::JSON;
+		else if (su::starts_with(arg, "buffer=") && parseScaled(value, "km", sizeScales, n))
+			conf.buffer = n;
+		else if (su::starts_with(arg, "flush=") && su::ends_with(value, "ms") &&
+		         parseScaled(value.substr(0, value.size() - 2), "", sizeScales, n))
+			conf.flush_ms = n;
+		else if (su::starts_with(arg, "flush=") && parseScaled(value, "sm", timeScales, n))
+			conf.flush_ms = n;
+		else if (su::starts_with(arg, "sample=") && parseScaled(value, "", sizeScales, n) && n > 0)
+			conf.sample = n;
+		else
+			return false;
+	}
+	return true;
+}
+
 // the path must start with /, ends with /, no invalid char
 // duplicates path not allowed
 bool ConfigParser::validateLocation(const ConfigNode &node) {
@@ -300,8 +459,8 @@ bool ConfigParser::validateIndex(const ConfigNode &node) {
 
 // must be in the list
 bool ConfigParser::validateMethod(const ConfigNode &node) {
-	static const char *valid_methods[] = {"GET", "POST", "DELETE"};
-	const int n = 3;
+	static const char *valid_methods[] = {"GET", "POST", "PUT", "DELETE"};
+	const int n = 4;
 
 	for (size_t i = 0; i < node.args_.size(); ++i) {
 		bool found = false;
@@ -331,6 +490,99 @@ bool ConfigParser::validateAutoIndex(const ConfigNode &node) {
 	return true;
 }
 
+bool ConfigParser::validateOnOff(const ConfigNode &node) {
+	if (node.args_[0] != "on" && node.args_[0] != "off") {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    node.name_ + " must be 'on' or 'off'. Value " + node.args_[0] +
+		                        " on line " + su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+bool ConfigParser::validateGzipTypes(const ConfigNode &node) {
+	for (size_t i = 0; i < node.args_.size(); ++i) {
+		const std::string &type = node.args_[i];
+		if (type != "*" && !isMimeType(type)) {
+			logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+			                    "gzip_types: invalid MIME type '" + type + "' on line " +
+			                        su::to_string(node.line_));
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ConfigParser::validateGzipMinLength(const ConfigNode &node) {
+	const std::string &len = node.args_[0];
+	if (len.empty() || len.size() > 9 ||
+	    len.find_first_not_of("0123456789") != std::string::npos) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "gzip_min_length must be a number of bytes. Value " + len +
+		                        " on line " + su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+bool ConfigParser::validateDefaultType(const ConfigNode &node) {
+	if (!isMimeType(node.args_[0])) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "default_type: invalid MIME type '" + node.args_[0] + "' on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+bool ConfigParser::validateTypesFile(const ConfigNode &node) {
+	if (node.args_[0].empty() || node.args_[0].find('"') != std::string::npos) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "Invalid types_file: " + node.args_[0] + " on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+bool ConfigParser::validateMimeEntry(const ConfigNode &node) {
+	if (!node.children_.empty() || node.args_.empty() || !isMimeType(node.name_)) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "types: expected 'mime/type extension...;' on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+	for (size_t i = 0; i < node.args_.size(); ++i) {
+		if (node.args_[i].find_first_of("/\"'") != std::string::npos) {
+			logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+			                    "types: invalid extension '" + node.args_[i] + "' on line " +
+			                        su::to_string(node.line_));
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ConfigParser::validateStubStatus(const ConfigNode &node) {
+	if (!node.args_.empty() && node.args_[0] != "prometheus" && node.args_[0] != "basic") {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "stub_status must be 'prometheus' or 'basic'. Value " + node.args_[0] +
+		                        " on line " + su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+bool ConfigParser::validateAutoIndexFormat(const ConfigNode &node) {
+	if (node.args_[0] != "html" && node.args_[0] != "json") {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "autoindex_format must be 'html' or 'json'. Value " + node.args_[0] +
+		                        " on line " + su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
 bool ConfigParser::validateCGI(const ConfigNode &node) {
 
 	// CGI expects pairs: extension interpreter_path extension interpreter_path
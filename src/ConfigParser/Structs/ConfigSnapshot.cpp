@@ -0,0 +1,75 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConfigSnapshot.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 13:10:44 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 13:10:44 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "ConfigSnapshot.hpp"
+#include "src/Logger/AccessLog.hpp"
+#include "src/Logger/Logger.hpp"
+
+ConfigSnapshot::ConfigSnapshot(const std::vector<ServerConfig> &servers, const MimeTypes &types,
+                               Logger &lggr)
+    : _servers(servers),
+      _types(types),
+      _refs(1) {
+	// the tables point into _servers, which never changes from now on
+	for (std::vector<ServerConfig>::const_iterator it = _servers.begin(); it != _servers.end();
+	     ++it)
+		_listeners[it->getServerFD()].add(&(*it));
+	for (std::map<int, VirtualHosts>::iterator it = _listeners.begin(); it != _listeners.end();
+	     ++it)
+		it->second.build();
+	openAccessLogs(lggr);
+}
+
+ConfigSnapshot::~ConfigSnapshot() {
+	for (std::vector<ServerConfig>::iterator it = _servers.begin(); it != _servers.end(); ++it)
+		if (it->getAccessLog())
+			it->getAccessLog()->release();
+}
+
+// servers sharing a path share the file, and a reload keeps it open
+void ConfigSnapshot::openAccessLogs(Logger &lggr) {
+	for (std::vector<ServerConfig>::iterator it = _servers.begin(); it != _servers.end(); ++it) {
+		const AccessLogConfig &conf = it->getAccessLogConfig();
+		if (conf.path.empty())
+			continue;
+		AccessLog *log = AccessLog::acquire(conf.path, conf.buffer, conf.flush_ms);
+		if (log == NULL)
+			lggr.warn("Could not open access log " + conf.path + ": " + strerror(errno));
+		it->setAccessLog(log);
+	}
+}
+
+ConfigSnapshot *ConfigSnapshot::compile(const std::vector<ServerConfig> &servers,
+                                        const MimeTypes &types, Logger &lggr) {
+	return new ConfigSnapshot(servers, types, lggr);
+}
+
+ConfigSnapshot *ConfigSnapshot::retain() {
+	__sync_add_and_fetch(&_refs, 1);
+	return this;
+}
+
+void ConfigSnapshot::release() {
+	if (__sync_sub_and_fetch(&_refs, 1) == 0)
+		delete this;
+}
+
+const std::vector<ServerConfig> &ConfigSnapshot::servers() const { return _servers; }
+
+const VirtualHosts *ConfigSnapshot::listener(int fd) const {
+	std::map<int, VirtualHosts>::const_iterator it = _listeners.find(fd);
+	return (it == _listeners.end()) ? NULL : &it->second;
+}
+
+const std::map<int, VirtualHosts> &ConfigSnapshot::listeners() const { return _listeners; }
+
+const MimeTypes &ConfigSnapshot::mimeTypes() const { return _types; }
@@ -0,0 +1,66 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConfigSnapshot.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 13:10:44 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 13:10:44 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CONFIGSNAPSHOT_HPP
+#define CONFIGSNAPSHOT_HPP
+
+#include "includes/Webserv.hpp"
+#include "src/ConfigParser/Structs/Struct.hpp"
+#include "src/ConfigParser/Structs/VirtualHosts.hpp"
+#include "src/Utils/MimeTypes.hpp"
+
+class Logger;
+
+/// Compiled, read-only configuration: the servers, their locations, the
+/// virtual host table of every listening socket and the MIME table.
+///
+/// A snapshot is never modified once compiled; per-request state lives on the
+/// Connection. It is reference counted: the server holds one reference to the
+/// current snapshot and every connection holds one to the snapshot it was
+/// accepted with, so a new snapshot can replace the current one while older
+/// connections finish on theirs. The count is updated atomically.
+///
+/// Each snapshot also holds a reference to the access log of its servers.
+class ConfigSnapshot {
+  public:
+	/// Copies the servers (listening fds already set) and builds their tables.
+	/// Access logs that can't be opened are reported to `lggr`.
+	/// \returns A snapshot holding one reference, for the caller.
+	static ConfigSnapshot *compile(const std::vector<ServerConfig> &servers,
+	                               const MimeTypes &types, Logger &lggr);
+
+	/// Takes a reference. \returns this, for convenience.
+	ConfigSnapshot *retain();
+	/// Drops a reference, deleting the snapshot with the last one.
+	void release();
+
+	const std::vector<ServerConfig> &servers() const;
+	/// \returns The servers sharing listening socket `fd`, NULL if it is not one.
+	const VirtualHosts *listener(int fd) const;
+	const std::map<int, VirtualHosts> &listeners() const;
+	const MimeTypes &mimeTypes() const;
+
+  private:
+	std::vector<ServerConfig> _servers;
+	std::map<int, VirtualHosts> _listeners; // listening fd -> servers sharing it
+	MimeTypes _types;
+	int _refs;
+
+	ConfigSnapshot(const std::vector<ServerConfig> &servers, const MimeTypes &types,
+	               Logger &lggr);
+	~ConfigSnapshot();
+	void openAccessLogs(Logger &lggr);
+	ConfigSnapshot(const ConfigSnapshot &);
+	ConfigSnapshot &operator=(const ConfigSnapshot &);
+};
+
+#endif /* end of include guard: CONFIGSNAPSHOT_HPP */
@@ -34,14 +34,6 @@ std::string LocConfig::getRoot() const {
     return path;
 }
 
-std::string LocConfig::getFullPath() const { 
-    return full_path; 
-}
-
-void LocConfig::setFullPath(const std::string &path) { 
-    full_path = path; 
-}
-
 std::string LocConfig::getUploadPath() const { 
     return upload_path; 
 }
@@ -69,7 +61,7 @@ bool LocConfig::hasMethod(const std::string &method) const {
     return false;
 }
 
-std::string LocConfig::getAllowedMethodsString() {
+std::string LocConfig::getAllowedMethodsString() const {
     std::string allowed;
     for (size_t i = 0; i < allowed_methods.size(); ++i) {
         allowed += allowed_methods[i];
@@ -94,3 +86,48 @@ std::string LocConfig::getInterpreter(const std::string &ext) const {
         return "";
 }
 
+bool LocConfig::gzipOn() const {
+    return gzip == 1;
+}
+
+bool LocConfig::gzipStaticOn() const {
+    return gzip_static == 1;
+}
+
+bool LocConfig::serverTimingOn() const {
+    return server_timing == 1;
+}
+
+bool LocConfig::uploadOn() const {
+    return upload == 1;
+}
+
+size_t LocConfig::getUploadMaxFileSize() const {
+    return upload_max_file_size;
+}
+
+bool LocConfig::uploadFsyncOn() const {
+    return upload_fsync == 1;
+}
+
+size_t LocConfig::getGzipMinLength() const {
+    return (gzip_min_length < 0) ? GZIP_MIN_LENGTH : gzip_min_length;
+}
+
+// Matches the media type of a Content-Type value (parameters ignored)
+bool LocConfig::gzipType(const std::string &ctype) const {
+    std::string type = su::to_lower(su::trim(ctype.substr(0, ctype.find(';'))));
+    if (type == "text/html")
+        return true;
+    for (std::vector<std::string>::const_iterator it = gzip_types.begin();
+         it != gzip_types.end(); ++it) {
+        if (*it == "*" || *it == type)
+            return true;
+    }
+    return false;
+}
+
+const std::string &LocConfig::getDefaultType() const {
+    static const std::string octetStream = "application/octet-stream";
+    return default_type.empty() ? octetStream : default_type;
+}
@@ -0,0 +1,96 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LocationTrie.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:40:12 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 11:40:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "LocationTrie.hpp"
+
+LocationTrie::LocationTrie() { clear(); }
+
+void LocationTrie::clear() {
+	_nodes.clear();
+	_nodes.push_back(Node(""));
+}
+
+long LocationTrie::childFor(const Node &node, char c) const {
+	for (size_t i = 0; i < node.children.size(); ++i) {
+		if (_nodes[node.children[i]].label[0] == c)
+			return node.children[i];
+	}
+	return -1;
+}
+
+void LocationTrie::insert(const std::string &path, size_t index, bool exact) {
+	size_t current = 0;
+	size_t pos = 0;
+
+	while (pos < path.size()) {
+		long child = childFor(_nodes[current], path[pos]);
+		if (child == -1) {
+			_nodes.push_back(Node(path.substr(pos)));
+			_nodes[current].children.push_back(_nodes.size() - 1);
+			current = _nodes.size() - 1;
+			pos = path.size();
+			break;
+		}
+		const std::string &label = _nodes[child].label;
+		size_t common = 0;
+		while (common < label.size() && pos + common < path.size() &&
+		       label[common] == path[pos + common])
+			++common;
+		if (common < label.size()) {
+			// split the edge: child keeps the tail, a new node takes the head
+			Node head(label.substr(0, common));
+			_nodes[child].label.erase(0, common);
+			head.children.push_back(child);
+			_nodes.push_back(head);
+			size_t headIndex = _nodes.size() - 1;
+			std::replace(_nodes[current].children.begin(), _nodes[current].children.end(),
+			             static_cast<size_t>(child), headIndex);
+			child = headIndex;
+		}
+		current = child;
+		pos += common;
+	}
+	Node &node = _nodes[current];
+	node.location = index;
+	node.exact = exact;
+	node.slash_end = !path.empty() && path[path.size() - 1] == '/';
+}
+
+bool LocationTrie::boundaryOK(const Node &node, const std::string &uri, size_t pos) const {
+	if (pos == uri.size())
+		return true; // the path itself
+	if (node.exact)
+		return false;
+	return pos == 0 || node.slash_end || uri[pos] == '/';
+}
+
+long LocationTrie::match(const std::string &uri) const {
+	const Node *node = &_nodes[0];
+	size_t pos = 0;
+	long best = -1;
+
+	for (;;) {
+		if (node->location != -1 && boundaryOK(*node, uri, pos))
+			best = node->location;
+		if (pos == uri.size())
+			break;
+		long child = childFor(*node, uri[pos]);
+		if (child == -1)
+			break;
+		const std::string &label = _nodes[child].label;
+		if (uri.compare(pos, label.size(), label) != 0)
+			break;
+		pos += label.size();
+		node = &_nodes[child];
+	}
+	return best;
+}
@@ -0,0 +1,56 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LocationTrie.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:40:12 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 11:40:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef LOCATIONTRIE_HPP
+#define LOCATIONTRIE_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Radix trie over the location paths of a server.
+///
+/// Built once at config load; match() walks the request path a single time
+/// and returns the longest location that matches it, with the same rules as
+/// the former linear scan: a location matches the path itself, or any path
+/// continuing with '/' (or any continuation if the location ends with '/'),
+/// unless it is an exact-match location. Nothing is allocated while matching.
+class LocationTrie {
+  public:
+	LocationTrie();
+
+	void clear();
+	/// \param index Position of the location in ServerConfig::locations.
+	void insert(const std::string &path, size_t index, bool exact);
+	/// \returns The index of the best location for `uri`, or -1.
+	long match(const std::string &uri) const;
+
+  private:
+	struct Node {
+		std::string label;           // edge label from the parent
+		std::vector<size_t> children; // node indices, one per first character
+		long location;               // location ending here, -1 if none
+		bool exact;
+		bool slash_end;
+
+		Node(const std::string &l)
+		    : label(l),
+		      location(-1),
+		      exact(false),
+		      slash_end(false) {}
+	};
+
+	std::vector<Node> _nodes; // _nodes[0] is the root (empty label)
+
+	long childFor(const Node &node, char c) const;
+	bool boundaryOK(const Node &node, const std::string &uri, size_t pos) const;
+};
+
+#endif /* end of include guard: LOCATIONTRIE_HPP */
@@ -32,6 +32,14 @@ int ServerConfig::getServerFD() const {
     return server_fd; 
 }
 
+const std::vector<std::string> &ServerConfig::getServerNames() const { 
+    return server_names; 
+}
+
+bool ServerConfig::isDefaultServer() const { 
+    return default_server; 
+}
+
 const std::string &ServerConfig::getPrefix() const { 
     return prefix_; 
 }
@@ -61,6 +69,26 @@ std::string ServerConfig::getErrorPage(uint16_t status) const {
     return (it != error_pages.end()) ? it->second : "";
 }
 
+const AccessLogConfig &ServerConfig::getAccessLogConfig() const {
+    return access_log_conf;
+}
+
+AccessLog *ServerConfig::getAccessLog() const {
+    return access_log;
+}
+
+void ServerConfig::setAccessLog(AccessLog *log) {
+    access_log = log;
+}
+
+size_t ServerConfig::getMetricsSlot() const {
+    return metrics_slot;
+}
+
+void ServerConfig::setMetricsSlot(size_t slot) {
+    metrics_slot = slot;
+}
+
 // The default location
 LocConfig *ServerConfig::defaultLocation() {
     for (std::vector<LocConfig>::iterator it = locations.begin(); it != locations.end(); ++it) {
@@ -71,6 +99,19 @@ LocConfig *ServerConfig::defaultLocation() {
     return NULL;
 }
 
+// (Re)builds the location trie, to call whenever locations change
+void ServerConfig::indexLocations() {
+    location_trie.clear();
+    for (size_t i = 0; i < locations.size(); ++i)
+        location_trie.insert(locations[i].getPath(), i, locations[i].is_exact_());
+}
+
+// Longest matching location for the request path
+const LocConfig *ServerConfig::findLocation(const std::string &uri) const {
+    long index = location_trie.match(uri);
+    return (index == -1) ? NULL : &locations[index];
+}
+
 // Find by server_fd
 ServerConfig *ServerConfig::find(std::vector<ServerConfig> &servers, int server_fd) {
     for (std::vector<ServerConfig>::iterator it = servers.begin(); it != servers.end(); ++it) {
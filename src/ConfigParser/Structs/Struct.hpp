@@ -16,6 +16,8 @@
 #include "includes/Webserv.hpp"
 #include "src/Logger/Logger.hpp"
 #include "src/Utils/StringUtils.hpp"
+#include "src/ConfigParser/Structs/LocationTrie.hpp"
+#include "src/ConfigParser/Structs/VirtualHosts.hpp"
 
 #ifndef SIZE_MAX
 #define SIZE_MAX ((size_t)-1)
@@ -25,6 +27,20 @@ class ConfigNode;
 class ServerConfig;
 class LocConfig;
 class WebServer;
+class AccessLog;
+
+// access_log path [combined|timing|json] [buffer=size] [flush=time] [sample=n]
+struct AccessLogConfig {
+	enum Format { COMBINED, TIMING, JSON };
+
+	std::string path; // empty: no access log
+	Format format;
+	size_t buffer;    // bytes held before a write, 0 writes every line
+	long flush_ms;    // oldest buffered line is written after this, 0 never
+	unsigned sample;  // log one request in n, errors (>= 400) always
+
+	AccessLogConfig() : format(COMBINED), buffer(0), flush_ms(0), sample(1) {}
+};
 
 
 class LocConfig {
@@ -34,7 +50,6 @@ class LocConfig {
   private:
 	std::string path;
 	bool exact_match;
-	std::string full_path;
 	std::vector<std::string> allowed_methods;
 	uint16_t return_code;
 	std::string return_target;
@@ -42,9 +57,22 @@ class LocConfig {
 	bool body_size_set;
 	std::string root;
 	bool autoindex;
+	bool autoindex_json;
 	std::string index;
 	std::string upload_path;
 	std::map<std::string, std::string> cgi_extensions;
+	int gzip;                            // -1 unset (inherited), 0 off, 1 on
+	int gzip_static;                     // -1 unset (inherited), 0 off, 1 on
+	long gzip_min_length;                // -1 unset (inherited)
+	std::vector<std::string> gzip_types; // text/html is always compressed
+	std::string default_type;            // for unknown extensions
+	int server_timing;                   // -1 unset (inherited), 0 off, 1 on
+	int upload;                          // -1 unset (inherited), 0 off, 1 on
+	size_t upload_max_file_size;         // 0: only client_max_body_size applies
+	bool upload_max_set;
+	int upload_fsync;                    // -1 unset (inherited), 0 off, 1 on
+	StatusFormat stub_status;            // metrics page instead of files
+	size_t metrics_slot;                 // set by the server when compiling
 
   public:
 	LocConfig()
@@ -52,23 +80,41 @@ class LocConfig {
 		  return_code(0),
 		  client_max_body_size(1048576),
 		  body_size_set(false),
-		  autoindex(false)  {}
+		  autoindex(false),
+		  autoindex_json(false),
+		  gzip(-1),
+		  gzip_static(-1),
+		  gzip_min_length(-1),
+		  server_timing(-1),
+		  upload(-1),
+		  upload_max_file_size(0),
+		  upload_max_set(false),
+		  upload_fsync(-1),
+		  stub_status(STATUS_OFF),
+		  metrics_slot(0)  {}
 
 	// GETTERS & SETTERS
 	std::string getPath() const;
 	bool is_exact_() const;
 	std::string getRoot() const;
-	std::string getFullPath() const;
 	std::string getUploadPath() const;
 	size_t getMaxBodySize() const;
 	bool infiniteBodySize() const;
 	bool hasReturn() const;
 	bool hasMethod(const std::string &method) const;
-	std::string getAllowedMethodsString();
+	std::string getAllowedMethodsString() const;
 	bool acceptExtension(const std::string &ext) const;
 	std::string getInterpreter(const std::string &ext) const;
+	bool gzipOn() const;
+	bool gzipStaticOn() const;
+	size_t getGzipMinLength() const;
+	bool gzipType(const std::string &ctype) const;
+	const std::string &getDefaultType() const;
+	bool serverTimingOn() const;
+	bool uploadOn() const;
+	size_t getUploadMaxFileSize() const;
+	bool uploadFsyncOn() const;
 	void setExact(bool is_exact);
-	void setFullPath(const std::string &path);
 
 };
 
@@ -79,21 +125,33 @@ class ServerConfig {
   private:
 	std::string host;
 	int port;
+	std::vector<std::string> server_names; // lowercased, wildcards kept as written
+	bool default_server;                   // listen ... default_server
 	std::map<uint16_t, std::string> error_pages;
 	std::vector<LocConfig> locations;
+	LocationTrie location_trie; // built from locations by indexLocations()
 	std::string prefix_;
 	int server_fd;
+	AccessLogConfig access_log_conf;
+	AccessLog *access_log; // opened by the configuration snapshot
+	size_t metrics_slot;   // requests matching no location
 
   public:
 	ServerConfig()
 	    : host("0.0.0.0"),
-	      port(8080)  {}
+	      port(8080),
+	      default_server(false),
+	      server_fd(-1),
+	      access_log(NULL),
+	      metrics_slot(0)  {}
 
 		  
 	// GETTERS
 	const std::string &getHost() const ;
 	int getPort() const;
 	int getServerFD() const;
+	const std::vector<std::string> &getServerNames() const;
+	bool isDefaultServer() const;
 	const std::string &getPrefix() const;
 	void setServerFD(int fd);
 	void setPrefix(const std::string& prefix);
@@ -101,10 +159,19 @@ class ServerConfig {
 	bool hasErrorPage(uint16_t status) const;
 	std::vector<LocConfig> &getLocations();
 	std::string getErrorPage(uint16_t status) const;
+	const AccessLogConfig &getAccessLogConfig() const;
+	AccessLog *getAccessLog() const;
+	void setAccessLog(AccessLog *log);
+	size_t getMetricsSlot() const;
+	void setMetricsSlot(size_t slot);
 
 
 	// The default location
 	LocConfig *defaultLocation();
+
+	// Location matching, through the trie
+	void indexLocations();
+	const LocConfig *findLocation(const std::string &uri) const;
 	
 	// Find by server_fd
 	static ServerConfig *find(std::vector<ServerConfig> &servers, int server_fd);
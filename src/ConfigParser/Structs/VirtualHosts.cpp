@@ -0,0 +1,138 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   VirtualHosts.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 12:05:31 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 12:05:31 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "VirtualHosts.hpp"
+#include "src/ConfigParser/Structs/Struct.hpp"
+
+VirtualHosts::VirtualHosts() : _default(NULL) {}
+
+void VirtualHosts::add(const ServerConfig *server) {
+	_servers.push_back(server);
+	if (!_default || (server->isDefaultServer() && !_default->isDefaultServer()))
+		_default = server;
+}
+
+void VirtualHosts::build() {
+	size_t count = 0;
+	for (size_t i = 0; i < _servers.size(); ++i)
+		count += _servers[i]->getServerNames().size();
+	size_t capacity = 8;
+	while (capacity < count * 2)
+		capacity *= 2;
+	_exact.assign(capacity, Name());
+	_leading.clear();
+	_trailing.clear();
+
+	for (size_t i = 0; i < _servers.size(); ++i) {
+		const std::vector<std::string> &names = _servers[i]->getServerNames();
+		for (size_t j = 0; j < names.size(); ++j) {
+			const std::string &name = names[j];
+			if (name.compare(0, 2, "*.") == 0)
+				_leading.push_back(Name(name.substr(1), _servers[i]));
+			else if (name[0] == '.') {
+				// ".example.com" is both "example.com" and "*.example.com"
+				insertExact(name.substr(1), _servers[i]);
+				_leading.push_back(Name(name, _servers[i]));
+			} else if (name.size() > 2 && name.compare(name.size() - 2, 2, ".*") == 0)
+				_trailing.push_back(Name(name.substr(0, name.size() - 1), _servers[i]));
+			else
+				insertExact(name, _servers[i]);
+		}
+	}
+	std::stable_sort(_leading.begin(), _leading.end(), longerName);
+	std::stable_sort(_trailing.begin(), _trailing.end(), longerName);
+}
+
+const ServerConfig *VirtualHosts::select(const std::string &host) const {
+	// strip the port, and the bracket of an IPv6 literal, and a trailing dot
+	size_t len = host.size();
+	if (!host.empty() && host[0] == '[') {
+		size_t close = host.find(']');
+		len = (close == std::string::npos) ? len : close + 1;
+	} else {
+		size_t colon = host.find(':');
+		len = (colon == std::string::npos) ? len : colon;
+	}
+	if (len > 0 && host[len - 1] == '.')
+		--len;
+	if (len == 0)
+		return _default;
+	const char *s = host.data();
+
+	const ServerConfig *server = findExact(s, len);
+	if (server)
+		return server;
+	for (size_t i = 0; i < _leading.size(); ++i) {
+		const std::string &suffix = _leading[i].name;
+		if (len > suffix.size() && sameName(suffix, s + len - suffix.size(), suffix.size()))
+			return _leading[i].server;
+	}
+	for (size_t i = 0; i < _trailing.size(); ++i) {
+		const std::string &prefix = _trailing[i].name;
+		if (len > prefix.size() && sameName(prefix, s, prefix.size()))
+			return _trailing[i].server;
+	}
+	return _default;
+}
+
+const ServerConfig *VirtualHosts::defaultServer() const { return _default; }
+
+size_t VirtualHosts::size() const { return _servers.size(); }
+
+// FNV-1a over the lowercased name
+size_t VirtualHosts::hash(const char *s, size_t len) {
+	size_t h = 2166136261u;
+	for (size_t i = 0; i < len; ++i) {
+		h ^= static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(s[i])));
+		h *= 16777619u;
+	}
+	return h;
+}
+
+// `name` is stored lowercased
+bool VirtualHosts::sameName(const std::string &name, const char *s, size_t len) {
+	if (name.size() != len)
+		return false;
+	for (size_t i = 0; i < len; ++i) {
+		if (name[i] != std::tolower(static_cast<unsigned char>(s[i])))
+			return false;
+	}
+	return true;
+}
+
+bool VirtualHosts::longerName(const Name &a, const Name &b) {
+	return a.name.size() > b.name.size();
+}
+
+// Linear probing; the first server defining a name keeps it
+void VirtualHosts::insertExact(const std::string &name, const ServerConfig *server) {
+	size_t mask = _exact.size() - 1;
+	for (size_t i = hash(name.data(), name.size()) & mask;; i = (i + 1) & mask) {
+		if (_exact[i].name.empty()) {
+			_exact[i] = Name(name, server);
+			return;
+		}
+		if (_exact[i].name == name)
+			return;
+	}
+}
+
+const ServerConfig *VirtualHosts::findExact(const char *s, size_t len) const {
+	if (_exact.empty())
+		return NULL;
+	size_t mask = _exact.size() - 1;
+	for (size_t i = hash(s, len) & mask; !_exact[i].name.empty(); i = (i + 1) & mask) {
+		if (sameName(_exact[i].name, s, len))
+			return _exact[i].server;
+	}
+	return NULL;
+}
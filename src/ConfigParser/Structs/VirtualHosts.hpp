@@ -0,0 +1,64 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   VirtualHosts.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 12:05:31 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 12:05:31 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef VIRTUALHOSTS_HPP
+#define VIRTUALHOSTS_HPP
+
+#include "includes/Webserv.hpp"
+
+class ServerConfig;
+
+/// The servers sharing one listening socket, selected by the Host header.
+///
+/// Built once at startup from the `server_name`s of the servers bound to the
+/// same host:port. Lookup order is the one of nginx: exact name (open
+/// addressing hash table), longest leading wildcard ("*.example.com"),
+/// longest trailing wildcard ("www.example.*"), then the default server
+/// (`listen ... default_server`, or the first server defined for the port).
+/// Names are case-insensitive; select() does not allocate.
+class VirtualHosts {
+  public:
+	VirtualHosts();
+
+	/// Registers a server and its names; call build() once all are added.
+	void add(const ServerConfig *server);
+	void build();
+
+	/// \param host Value of the Host header, port included or not.
+	/// \returns The server for `host`, the default server if no name matches.
+	const ServerConfig *select(const std::string &host) const;
+	const ServerConfig *defaultServer() const;
+	size_t size() const;
+
+  private:
+	struct Name {
+		std::string name; // lowercased, "" for an empty slot
+		const ServerConfig *server;
+
+		Name() : server(NULL) {}
+		Name(const std::string &n, const ServerConfig *s) : name(n), server(s) {}
+	};
+
+	std::vector<const ServerConfig *> _servers;
+	const ServerConfig *_default;
+	std::vector<Name> _exact;     // hash table, size is a power of two
+	std::vector<Name> _leading;   // ".example.com" suffixes, longest first
+	std::vector<Name> _trailing;  // "www.example." prefixes, longest first
+
+	static size_t hash(const char *s, size_t len);
+	static bool sameName(const std::string &name, const char *s, size_t len);
+	static bool longerName(const Name &a, const Name &b);
+	void insertExact(const std::string &name, const ServerConfig *server);
+	const ServerConfig *findExact(const char *s, size_t len) const;
+};
+
+#endif /* end of include guard: VIRTUALHOSTS_HPP */
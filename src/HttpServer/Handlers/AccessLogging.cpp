@@ -0,0 +1,206 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   AccessLogging.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 13:42:08 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 13:42:08 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/HttpServer.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/WebServer.hpp"
+#include "src/Logger/AccessLog.hpp"
+#include "src/Utils/ServerUtils.hpp"
+
+// Quotes and backslashes escaped, control bytes as \xHH (combined) or \u00HH (JSON)
+static void appendEscaped(std::string &out, const std::string &str, bool json) {
+	if (str.empty() && !json) {
+		out += '-';
+		return;
+	}
+	for (size_t i = 0; i < str.size(); ++i) {
+		unsigned char c = str[i];
+		if (c == '"' || c == '\\') {
+			out += '\\';
+			out += c;
+		} else if (c < 0x20 || c == 0x7f) {
+			char buf[8];
+			std::snprintf(buf, sizeof(buf), json ? "\\u%04x" : "\\x%02X", c);
+			out += buf;
+		} else
+			out += c;
+	}
+}
+
+static const std::string &header(const ClientRequest &req, const char *name) {
+	static const std::string none;
+	std::map<std::string, std::string>::const_iterator it = req.headers.find(name);
+	return (it == req.headers.end()) ? none : it->second;
+}
+
+// Local time of the request, formatted at most once per second
+static const char *logTime(bool json) {
+	static time_t cached = -1;
+	static char clf[32];
+	static char iso[32];
+	time_t now = time(NULL);
+	if (now != cached) {
+		struct tm tm;
+		localtime_r(&now, &tm);
+		long offset = tm.tm_gmtoff / 60; // %z is not C++98
+		char zone[8];
+		std::snprintf(zone, sizeof(zone), "%c%02ld%02ld", offset < 0 ? '-' : '+',
+		              std::labs(offset) / 60, std::labs(offset) % 60);
+		size_t len = strftime(clf, sizeof(clf) - sizeof(zone), "%d/%b/%Y:%H:%M:%S ", &tm);
+		std::strcpy(clf + len, zone);
+		len = strftime(iso, sizeof(iso) - sizeof(zone), "%Y-%m-%dT%H:%M:%S", &tm);
+		std::strcpy(iso + len, zone);
+		cached = now;
+	}
+	return json ? iso : clf;
+}
+
+// seconds with `decimals`, or `none` for a phase the request skipped
+static void appendSeconds(std::string &line, long us, int decimals, const char *none) {
+	if (us < 0) {
+		line += none;
+		return;
+	}
+	char buf[32];
+	std::snprintf(buf, sizeof(buf), "%.*f", decimals, us / 1e6);
+	line += buf;
+}
+
+// remote - - [time] "request" status bytes "referer" "user-agent" request_time cgi_time,
+// then phase=seconds pairs for the timing format
+static void formatCombined(std::string &line, const std::string &remote, const ClientRequest &req,
+                           int status, size_t bytes, const RequestTiming &timing, bool phases) {
+	char buf[64];
+	long durations[PHASE_COUNT];
+	timing.phases(durations);
+
+	line += remote;
+	line += " - - [";
+	line += logTime(false);
+	line += "] \"";
+	if (req.method.empty())
+		line += '-';
+	else {
+		appendEscaped(line, req.method, false);
+		line += ' ';
+		appendEscaped(line, req.uri, false);
+		line += ' ';
+		appendEscaped(line, req.version, false);
+	}
+	std::snprintf(buf, sizeof(buf), "\" %d %lu \"", status, static_cast<unsigned long>(bytes));
+	line += buf;
+	appendEscaped(line, header(req, "referer"), false);
+	line += "\" \"";
+	appendEscaped(line, header(req, "user-agent"), false);
+	line += "\" ";
+	appendSeconds(line, timing.total(), 3, "-");
+	line += ' ';
+	appendSeconds(line, durations[PHASE_CGI], 3, "-");
+	for (int i = 0; phases && i < PHASE_COUNT; ++i) {
+		if (i == PHASE_CGI)
+			continue;
+		line += ' ';
+		line += RequestTiming::phaseName(i);
+		line += '=';
+		appendSeconds(line, durations[i], 6, "-");
+	}
+	line += '\n';
+}
+
+static void jsonField(std::string &line, const char *name, const std::string &value) {
+	line += ",\"";
+	line += name;
+	line += "\":\"";
+	appendEscaped(line, value, true);
+	line += '"';
+}
+
+// One object per line, times in seconds, null for the phases the request skipped
+static void formatJson(std::string &line, const std::string &remote, const ClientRequest &req,
+                       int status, size_t bytes, const RequestTiming &timing) {
+	char buf[64];
+	long durations[PHASE_COUNT];
+	timing.phases(durations);
+
+	line += "{\"time\":\"";
+	line += logTime(true);
+	line += '"';
+	jsonField(line, "remote_addr", remote);
+	jsonField(line, "host", header(req, "host"));
+	jsonField(line, "method", req.method);
+	jsonField(line, "uri", req.uri);
+	jsonField(line, "protocol", req.version);
+	std::snprintf(buf, sizeof(buf), ",\"status\":%d,\"bytes\":%lu", status,
+	              static_cast<unsigned long>(bytes));
+	line += buf;
+	jsonField(line, "referer", header(req, "referer"));
+	jsonField(line, "user_agent", header(req, "user-agent"));
+	line += ",\"request_time\":";
+	appendSeconds(line, timing.total(), 3, "null");
+	for (int i = 0; i < PHASE_COUNT; ++i) {
+		line += ",\"";
+		line += RequestTiming::phaseName(i);
+		line += "_time\":";
+		appendSeconds(line, durations[i], i == PHASE_CGI ? 3 : 6, "null");
+	}
+	line += "}\n";
+}
+
+void WebServer::logAccess(Connection *conn) {
+	if (Tracer::enabled() && conn->timing.start) {
+		const ClientRequest &req = conn->parsed_request;
+		Tracer::request(conn->fd, conn->timing.start, conn->timing.done,
+		                req.method + " " + req.uri + " " +
+		                    su::to_string(conn->response.status_code));
+	}
+
+	const ServerConfig *server = conn->servConfig;
+	if (server == NULL && conn->vhosts)
+		server = conn->vhosts->defaultServer();
+	if (server == NULL || server->getAccessLog() == NULL)
+		return;
+
+	AccessLog *log = server->getAccessLog();
+	const AccessLogConfig &conf = server->getAccessLogConfig();
+	int status = conn->response.status_code;
+	if (status < 400 && !log->sample(conf.sample))
+		return;
+
+	_access_line.clear();
+	const ClientRequest &req = conn->parsed_request;
+	if (conf.format == AccessLogConfig::JSON)
+		formatJson(_access_line, conn->remote_addr, req, status, conn->bytes_sent, conn->timing);
+	else
+		formatCombined(_access_line, conn->remote_addr, req, status, conn->bytes_sent,
+		               conn->timing, conf.format == AccessLogConfig::TIMING);
+	log->append(_access_line);
+}
+
+void WebServer::reopenLogs() {
+	// ws.log first: it reports the access logs that can't be reopened
+	if (!_lggr.reopen())
+		_lggr.error("Could not reopen ws.log");
+	AccessLog::reopenAll(_lggr);
+	LOG_INFO(_lggr, "Log files reopened");
+}
+
+void WebServer::toggleTrace() {
+	if (!Tracer::enabled()) {
+		Tracer::start();
+		LOG_INFO(_lggr, "Tracing started, SIGPROF again writes " + trace_file);
+		return;
+	}
+	if (Tracer::dump(trace_file))
+		LOG_INFO(_lggr, "Trace written to " + trace_file);
+	else
+		_lggr.error("Failed to write trace to " + trace_file + ": " + strerror(errno));
+}
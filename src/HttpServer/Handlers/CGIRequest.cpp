@@ -19,13 +19,18 @@ uint16_t WebServer::handleCGIRequest(ClientRequest &req, Connection *conn) {
     Logger _lggr;
 
     CGI *cgi = NULL;
-    uint16_t exit_code = CGIUtils::createCGI(cgi, req, conn->locConfig);
-    if (exit_code)
+    conn->timing.cgi_start = monotonicUs();
+    uint16_t exit_code = CGIUtils::createCGI(cgi, req, conn->locConfig, conn->full_path);
+    if (exit_code) {
+        ++_metrics.cgi_failed;
         return (exit_code);
+    }
+    ++_metrics.cgi_spawned;
 
     _cgi_pool[cgi->getOutputFd()] = std::make_pair(cgi, conn);
     if (!epollManage(EPOLL_CTL_ADD, cgi->getOutputFd(), EPOLLIN)) {
         _lggr.error("EPollManage for CGI request failed.");
+        ++_metrics.cgi_failed;
         return (502);
     }
 
@@ -27,31 +27,54 @@ void WebServer::handleClientEvent(int fd, uint32_t event_mask) {
         }
         if (event_mask & EPOLLOUT) {
             if (conn->response_ready) {
-                if (!sendResponse(conn))
+                if (!sendResponse(conn)) {
+                    conn->timing.done = monotonicUs();
+                    logAccess(conn); // what went out before the error
+                    recordMetrics(conn);
                     closeConnection(conn);
+                    return;
+                }
             } else {
                 _lggr.error("Response is not ready to be sent back to the client");
-                _lggr.debug("Error for clinet " + conn->toString());
+                LOG_DEBUG(_lggr, "Error for clinet " + conn->toString());
             }
-            if (!conn->keep_persistent_connection || conn->should_close)
-                closeConnection(conn);
+            // Close only once the whole response went out
+            if (!conn->response_ready &&
+                (!conn->keep_persistent_connection || conn->should_close)) {
+                if (conn->should_close)
+                    lingerClose(conn);
+                else
+                    closeConnection(conn);
+                return;
+            }
+            // The client may have sent the next request along with this one
+            if (!conn->response_ready)
+                servePipelined(conn);
         }
         if (event_mask & (EPOLLERR | EPOLLHUP)) {
             _lggr.error("Error/hangup event for fd: " + su::to_string(fd));
             closeConnection(conn);
         }
     } else {
-        _lggr.debug("Ignoring event for unknown fd: " + su::to_string(fd));
+        LOG_DEBUG(_lggr, "Ignoring event for unknown fd: " + su::to_string(fd));
         epollManage(EPOLL_CTL_DEL, fd, 0);
         close(fd);
     }
 }
 
 void WebServer::handleClientRecv(Connection *conn) {
-    _lggr.debug("Updated last activity for FD " + su::to_string(conn->fd));
+    if (conn->state == Connection::LINGERING) {
+        // the rest of a refused request, activity is not refreshed
+        char discard[BUFFER_SIZE];
+        if (recv(conn->fd, discard, sizeof(discard), 0) <= 0)
+            closeConnection(conn);
+        return;
+    }
+    LOG_DEBUG(_lggr, "Updated last activity for FD " + su::to_string(conn->fd));
     conn->updateActivity();
 
     char buffer[BUFFER_SIZE];
+    TraceSpan span("recv", "net", conn->fd);
 
     ssize_t bytes_read = receiveData(conn->fd, buffer, sizeof(buffer) - 1);
 
@@ -75,12 +98,12 @@ ssize_t WebServer::receiveData(int client_fd, char *buffer, size_t buffer_size)
     errno = 0;
     ssize_t bytes_read = recv(client_fd, buffer, buffer_size, 0);
 
-    _lggr.logWithPrefix(Logger::DEBUG, "recv", "Bytes received: " + su::to_string(bytes_read));
+    LOG_DEBUG_P(_lggr, "recv", "Bytes received: " + su::to_string(bytes_read));
     if (bytes_read > 0) {
         buffer[bytes_read] = '\0';
     }
 
-    _lggr.logWithPrefix(Logger::DEBUG, "recv", "Data: " + std::string(buffer));
+    LOG_DEBUG_P(_lggr, "recv", "Data: " + std::string(buffer));
 
     return bytes_read;
 }
@@ -88,31 +111,46 @@ ssize_t WebServer::receiveData(int client_fd, char *buffer, size_t buffer_size)
 bool WebServer::processReceivedData(Connection *conn, const char *buffer, ssize_t bytes_read) {
             
     if (conn->state == Connection::READING_HEADERS) {
-        conn->read_buffer += std::string(buffer, bytes_read);
+        if (conn->read_buffer.empty()) { // first bytes of a new request
+            conn->timing.begin(monotonicUs());
+            conn->bytes_received = 0;
+        }
+        conn->read_buffer.append(buffer, bytes_read);
     }
 
-    else if (conn->state == Connection::READING_BODY) {
-        conn->body_data.insert(conn->body_data.end(),
-                               reinterpret_cast<const unsigned char *>(buffer),
-                               reinterpret_cast<const unsigned char *>(buffer + bytes_read));
-        conn->body_bytes_read += bytes_read;
-
-        _lggr.debug("Read " + su::to_string(conn->body_bytes_read) + " bytes of body so far");
+    else if (conn->state == Connection::READING_BODY) { // straight into the request body
+        size_t taken = std::min(static_cast<size_t>(bytes_read), conn->bodyLeft());
+        if (!conn->appendBody(buffer, taken))
+            uploadError(conn);
+        conn->read_buffer.append(buffer + taken, bytes_read - taken); // pipelined request
+        LOG_DEBUG(_lggr, "Read " + su::to_string(conn->body_received) + " bytes of body so far");
     }
 
-    else {
-        conn->read_buffer += std::string(buffer, bytes_read);
-        if (conn->state == Connection::READING_BODY) {
-            conn->body_bytes_read += bytes_read;
-        }
-    }
+    else
+        conn->read_buffer.append(buffer, bytes_read);
+
+    conn->bytes_received += bytes_read;
+    _metrics.bytes_in += bytes_read;
+
+    return serveRequest(conn);
+}
+
+bool WebServer::servePipelined(Connection *conn) {
+    if (conn->read_buffer.empty() || conn->state != Connection::READING_HEADERS)
+        return true;
+    LOG_DEBUG(_lggr, "Pipelined request waiting on fd " + su::to_string(conn->fd));
+    conn->timing.begin(monotonicUs());
+    conn->bytes_received = conn->read_buffer.size();
+    return serveRequest(conn);
+}
 
-    _lggr.debug("Checking if request was completed");
+bool WebServer::serveRequest(Connection *conn) {
+    LOG_DEBUG(_lggr, "Checking if request was completed");
     if (isRequestComplete(conn)) {
         if (!epollManage(EPOLL_CTL_MOD, conn->fd, EPOLLOUT)) {
             return false;
         }
-        _lggr.debug("Request was completed");
+        LOG_DEBUG(_lggr, "Request was completed");
         if (conn->should_close)
             return false;
         return handleCompleteRequest(conn);
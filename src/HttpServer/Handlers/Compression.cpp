@@ -0,0 +1,65 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Compression.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 13:02:55 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 13:02:55 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/HttpServer.hpp"
+#include "src/HttpServer/Structs/BodyStream.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/Response.hpp"
+#include "src/HttpServer/Structs/WebServer.hpp"
+
+void WebServer::applyContentEncoding(Connection *conn) {
+	Response &resp = conn->response;
+	const LocConfig *loc = conn->locConfig;
+
+	if (loc == NULL || !loc->gzipOn() || resp.status_code != 200 ||
+	    resp.headers.count("Content-Encoding"))
+		return;
+	std::map<std::string, std::string>::const_iterator ctype = resp.headers.find("Content-Type");
+	if (ctype == resp.headers.end() || !loc->gzipType(ctype->second))
+		return;
+	resp.setHeader("Vary", "Accept-Encoding");
+	if (!acceptsGzip(conn->parsed_request))
+		return;
+
+	if (resp.hasFileBody()) {
+		// chunked framing is HTTP/1.1 only; a single part is the whole file
+		if (conn->parsed_request.version != "HTTP/1.1" || resp.file_parts.size() != 1 ||
+		    resp.file_parts[0].length < loc->getGzipMinLength())
+			return;
+		const BodyPart &part = resp.file_parts[0];
+		resp.stream = new GzipStream(new FileStream(resp.file_fd, part.offset, part.length));
+		resp.file_parts.clear();
+		resp.headers.erase("Content-Length");
+		resp.headers.erase("Accept-Ranges");
+		resp.setHeader("Transfer-Encoding", "chunked");
+	} else if (resp.hasStream()) {
+		// already chunked (e.g. directory listing): compress on the way out
+		resp.stream = new GzipStream(resp.stream);
+	} else {
+		std::string compressed;
+		if (resp.body.size() < loc->getGzipMinLength())
+			return;
+		if (!gzipCompress(resp.body, compressed)) {
+			_lggr.error("gzip compression failed, sending identity body");
+			return;
+		}
+		LOG_DEBUG(_lggr, "gzip: " + su::to_string(resp.body.size()) + " -> " +
+		                 su::to_string(compressed.size()) + " bytes");
+		resp.body.swap(compressed);
+		resp.setContentLength(resp.body.size());
+	}
+	// the encoded representation is no longer byte-identical to the file
+	std::map<std::string, std::string>::iterator etag = resp.headers.find("ETag");
+	if (etag != resp.headers.end() && !su::starts_with(etag->second, "W/"))
+		etag->second = "W/" + etag->second;
+	resp.setHeader("Content-Encoding", "gzip");
+}
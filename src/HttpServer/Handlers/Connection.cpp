@@ -15,37 +15,51 @@
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/HttpServer/Structs/WebServer.hpp"
 
-void WebServer::handleNewConnection(ServerConfig *sc) {
+void WebServer::handleNewConnection(int listen_fd, const VirtualHosts *vh) {
 	struct sockaddr_in client_addr;
 	socklen_t client_len = sizeof(client_addr);
 
-	int client_fd = accept(sc->getServerFD(), (struct sockaddr *)&client_addr, &client_len);
+	int client_fd = accept(listen_fd, (struct sockaddr *)&client_addr, &client_len);
 	if (client_fd == -1) {
 		return;
 	}
+	long accepted = monotonicUs();
+	++_metrics.accepted;
 
 	if (!setNonBlocking(client_fd)) {
 		close(client_fd);
 		return;
 	}
+	// headers and file body go out in separate writes, the body must not wait
+	// on Nagle and the client's delayed ACK
+	int one = 1;
+	if (setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) == -1)
+		_lggr.warn("Failed to set TCP_NODELAY on fd: " + su::to_string(client_fd));
 
-	Connection *conn = addConnection(client_fd, sc);
+	Connection *conn = addConnection(client_fd, vh);
+	conn->remote_addr = inet_ntoa(client_addr.sin_addr);
+	conn->timing.accepted = accepted;
+	Tracer::record("accept", "net", client_fd, accepted, Tracer::now(), conn->remote_addr);
 
 	if (!epollManage(EPOLL_CTL_ADD, client_fd, EPOLLIN)) {
 		closeConnection(conn);
+		return;
 	}
+	++_metrics.handled;
 
-	_lggr.info("New connection from " + std::string(inet_ntoa(client_addr.sin_addr)) + ":" +
-	           su::to_string<unsigned short>(ntohs(client_addr.sin_port)) +
-	           " (fd: " + su::to_string<int>(client_fd) + ")");
+	LOG_INFO(_lggr, "New connection from " + conn->remote_addr + ":" +
+	                su::to_string<unsigned short>(ntohs(client_addr.sin_port)) +
+	                " (fd: " + su::to_string<int>(client_fd) + ")");
 }
 
-Connection *WebServer::addConnection(int client_fd, ServerConfig *sc) {
+Connection *WebServer::addConnection(int client_fd, const VirtualHosts *vh) {
 	Connection *conn = new Connection(client_fd);
-	conn->servConfig = sc;
+	conn->config = _config->retain();
+	conn->vhosts = vh;
+	conn->servConfig = vh->defaultServer();
 	_connections[client_fd] = conn;
 
-	_lggr.debug("Added connection tracking for fd: " + su::to_string(client_fd));
+	LOG_DEBUG(_lggr, "Added connection tracking for fd: " + su::to_string(client_fd));
 	return conn;
 }
 
@@ -65,10 +79,12 @@ void WebServer::cleanupExpiredConnections() {
 	     ++it) {
 
 		Connection *conn = it->second;
+		if (conn->state == Connection::LINGERING) // closeLingered() handles those
+			continue;
 		if (conn->isExpired(time(NULL), CONNECTION_TO)) {
 			conn->keep_persistent_connection = false;
 			expired.push_back(conn);
-			_lggr.info("Connection expired for fd: " + su::to_string(conn->fd));
+			LOG_INFO(_lggr, "Connection expired for fd: " + su::to_string(conn->fd));
 		}
 	}
 
@@ -78,6 +94,18 @@ void WebServer::cleanupExpiredConnections() {
 	expired.clear();
 }
 
+void WebServer::closeLingered() {
+	long now = monotonicUs();
+	while (!_lingering.empty() && _lingering.front().second <= now) {
+		std::map<int, Connection *>::iterator it = _connections.find(_lingering.front().first);
+		_lingering.pop_front();
+		// the client may have closed first, and the fd been reused since
+		if (it != _connections.end() && it->second->state == Connection::LINGERING &&
+		    it->second->linger_until <= now)
+			closeConnection(it->second); // its response is already out
+	}
+}
+
 void WebServer::handleConnectionTimeout(int client_fd) {
 	std::map<int, Connection *>::iterator it = _connections.find(client_fd);
 	if (it != _connections.end()) {
@@ -85,21 +113,34 @@ void WebServer::handleConnectionTimeout(int client_fd) {
 
 		prepareResponse(conn, Response(408, conn));
 
-		_lggr.info("Connection timed out for fd: " + su::to_string(client_fd) + " (idle for " +
-		           su::to_string(getCurrentTime() - conn->last_activity) + " seconds)");
+		LOG_INFO(_lggr, "Connection timed out for fd: " + su::to_string(client_fd) + " (idle for " +
+		                su::to_string(getCurrentTime() - conn->last_activity) + " seconds)");
 		closeConnection(conn);
 	}
 }
 
+void WebServer::lingerClose(Connection *conn) {
+	if (shutdown(conn->fd, SHUT_WR) == -1 || !epollManage(EPOLL_CTL_MOD, conn->fd, EPOLLIN)) {
+		closeConnection(conn);
+		return;
+	}
+	LOG_DEBUG(_lggr, "Lingering before closing fd: " + su::to_string(conn->fd));
+	conn->state = Connection::LINGERING;
+	conn->read_buffer.clear();
+	conn->updateActivity();
+	conn->linger_until = monotonicUs() + LINGER_TO * 1000000L;
+	_lingering.push_back(std::make_pair(conn->fd, conn->linger_until));
+}
+
 void WebServer::closeConnection(Connection *conn) {
 	if (!conn)
 		return;
 
-	_lggr.debug("Closing connection for fd: " + su::to_string(conn->fd));
+	LOG_DEBUG(_lggr, "Closing connection for fd: " + su::to_string(conn->fd));
 
 	std::map<int, Connection *>::iterator it = _connections.find(conn->fd);
 	if (it == _connections.end()) {
-		_lggr.debug("Connection already closed for fd: " + su::to_string(conn->fd));
+		LOG_DEBUG(_lggr, "Connection already closed for fd: " + su::to_string(conn->fd));
 		return;
 	}
 	if (it->second != conn) {
@@ -107,8 +148,9 @@ void WebServer::closeConnection(Connection *conn) {
 		return;
 	}
 	epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+	conn->releaseResponse();
 	close(conn->fd);
 	_connections.erase(it);
-	_lggr.debug("Connection cleanup completed for fd: " + su::to_string(conn->fd));
+	LOG_DEBUG(_lggr, "Connection cleanup completed for fd: " + su::to_string(conn->fd));
 	delete conn;
 }
@@ -16,27 +16,69 @@
 #include "src/HttpServer/Structs/WebServer.hpp"
 
 void WebServer::processEpollEvents(const struct epoll_event *events, int event_count) {
+    TraceSpan batch("events", "loop", 0);
+    batch.detail(su::to_string(event_count) + " events");
     for (int i = 0; i < event_count; ++i) {
         const uint32_t event_mask = events[i].events;
         const int fd = events[i].data.fd;
+        long begin = monotonicUs();
+        int kind;
+        int client_fd = fd;
 
-        if (isListeningSocket(fd)) {
-            ServerConfig *sc = ServerConfig::find(_confs, fd);
-            handleNewConnection(sc);
+        const VirtualHosts *listener = isListeningSocket(fd) ? _config->listener(fd) : NULL;
+        if (listener) {
+            kind = EVENT_ACCEPT;
+            handleNewConnection(fd, listener);
+        } else if (fd == _upgrade_fd) {
+            kind = EVENT_UPGRADE;
+            handleUpgradeReady();
         } else if (isCGIFd(fd)) {
+            kind = EVENT_CGI;
+            client_fd = _cgi_pool[fd].second->fd;
             handleCGIOutput(fd);
         } else {
+            kind = EVENT_CLIENT;
             handleClientEvent(fd, event_mask);
         }
+
+        long took = monotonicUs() - begin;
+        _metrics.recordEvent(kind, took);
+        if (took > _slowest_event)
+            _slowest_event = took;
+        if (slow_event_ms > 0 && took >= slow_event_ms * 1000L)
+            reportSlowEvent(kind, fd, client_fd, took);
     }
 }
 
-bool WebServer::isListeningSocket(int fd) const {
-    for (std::vector<ServerConfig>::const_iterator it = _confs.begin(); it != _confs.end(); ++it) {
-        if (fd == it->getServerFD()) {
-            return true;
-        }
+void WebServer::reportSlowEvent(int kind, int fd, int client_fd, long us) {
+    ++_metrics.slow_events;
+    std::string msg = "Event loop blocked " + su::to_string(us / 1000) + " ms by " +
+                      eventKindName(kind) + " event on fd " + su::to_string(fd);
+    std::map<int, Connection *>::const_iterator it = _connections.find(client_fd);
+    if (it != _connections.end() && !it->second->parsed_request.method.empty()) {
+        const ClientRequest &req = it->second->parsed_request;
+        if (client_fd != fd)
+            msg += " (client fd " + su::to_string(client_fd) + ")";
+        msg += ": " + req.method + " " + req.uri;
     }
-    return false;
+    _lggr.warn(msg);
+}
+
+void WebServer::checkLoopLag(long busy_start, int event_count) {
+    long busy = monotonicUs() - busy_start;
+    long slowest = _slowest_event;
+    _slowest_event = 0;
+    _metrics.recordIteration(busy);
+    // a slow event was already reported, with its request
+    if (slow_event_ms <= 0 || busy < slow_event_ms * 1000L || slowest >= slow_event_ms * 1000L)
+        return;
+    _lggr.warn("Event loop iteration took " + su::to_string(busy / 1000) + " ms over " +
+               su::to_string(std::max(event_count, 0)) + " event(s), slowest " +
+               su::to_string(slowest / 1000) + " ms");
+}
+
+bool WebServer::isListeningSocket(int fd) const {
+    // a draining process closed its listeners, their fd numbers may be reused
+    return _config && !_draining && _config->listener(fd) != NULL;
 }
 
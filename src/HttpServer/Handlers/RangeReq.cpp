@@ -0,0 +1,146 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RangeReq.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:02:14 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 11:02:14 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/HttpServer.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/Response.hpp"
+#include "src/HttpServer/Structs/WebServer.hpp"
+#include "src/Utils/ServerUtils.hpp"
+
+// Parses a non-negative decimal byte position, rejecting signs and garbage
+static bool parseBytePos(const std::string &str, off_t &pos) {
+	if (str.empty() || str.length() > 18)
+		return false;
+	for (size_t i = 0; i < str.length(); ++i) {
+		if (!std::isdigit(static_cast<unsigned char>(str[i])))
+			return false;
+	}
+	return su::from_string(str, pos);
+}
+
+// Range: bytes=0-99, 200-, -50  (RFC 9110 section 14.1.2)
+// RANGE_NONE means the header must be ignored and the full file served.
+RangeStatus parseByteRanges(const std::string &header, off_t size,
+                            std::vector<std::pair<off_t, off_t> > &ranges) {
+	ranges.clear();
+	std::string value = su::trim(header);
+	if (!su::starts_with(value, "bytes="))
+		return RANGE_NONE;
+
+	std::vector<std::string> specs = su::split(value.substr(6), ',');
+	if (specs.empty() || specs.size() > MAX_BYTE_RANGES)
+		return RANGE_NONE;
+
+	for (size_t i = 0; i < specs.size(); ++i) {
+		std::string spec = su::trim(specs[i]);
+		size_t dash = spec.find('-');
+		if (dash == std::string::npos)
+			return RANGE_NONE;
+
+		std::string first = spec.substr(0, dash);
+		std::string last = spec.substr(dash + 1);
+		off_t start;
+		off_t end;
+
+		if (first.empty()) { // suffix range: last N bytes
+			off_t suffix;
+			if (!parseBytePos(last, suffix))
+				return RANGE_NONE;
+			if (suffix == 0 || size == 0)
+				continue;
+			start = (suffix >= size) ? 0 : size - suffix;
+			end = size - 1;
+		} else {
+			if (!parseBytePos(first, start))
+				return RANGE_NONE;
+			if (last.empty())
+				end = size - 1;
+			else if (!parseBytePos(last, end) || end < start)
+				return RANGE_NONE;
+			if (start >= size)
+				continue;
+			if (end >= size)
+				end = size - 1;
+		}
+		ranges.push_back(std::make_pair(start, end));
+	}
+	return ranges.empty() ? RANGE_NOT_SATISFIABLE : RANGE_SATISFIABLE;
+}
+
+// If-Range holds either an entity tag or an HTTP-date; on mismatch the
+// Range header is ignored and the whole (changed) file is sent.
+bool ifRangeMatches(const ClientRequest &req, const struct stat &st) {
+	std::map<std::string, std::string>::const_iterator it = req.headers.find("if-range");
+	if (it == req.headers.end())
+		return true;
+	const std::string &validator = it->second;
+	if (!validator.empty() && (validator[0] == '"' || su::starts_with(validator, "W/")))
+		return validator == makeETag(st); // weak tags never match
+	return validator == httpDate(st.st_mtime);
+}
+
+Response WebServer::respRangeRequest(Connection *conn, int fd, const struct stat &st,
+                                     const std::string &fullFilePath,
+                                     const std::vector<std::pair<off_t, off_t> > &ranges) {
+	const std::string size = su::to_string(st.st_size);
+
+	if (ranges.empty()) {
+		LOG_DEBUG(_lggr, "Range not satisfiable for " + fullFilePath + " (" + size + " bytes)");
+		close(fd);
+		Response resp(416, conn);
+		resp.setHeader("Content-Range", "bytes */" + size);
+		return resp;
+	}
+
+	Response resp(206);
+	resp.setHeader("Accept-Ranges", "bytes");
+	resp.setHeader("Last-Modified", httpDate(st.st_mtime));
+	resp.setHeader("ETag", makeETag(st));
+	resp.file_fd = fd;
+	std::string content_type = detectContentType(conn->config->mimeTypes(), fullFilePath,
+	                                             conn->locConfig->getDefaultType());
+
+	if (ranges.size() == 1) {
+		off_t start = ranges[0].first;
+		off_t end = ranges[0].second;
+		resp.setContentType(content_type);
+		resp.setContentLength(end - start + 1);
+		resp.setHeader("Content-Range", "bytes " + su::to_string(start) + "-" +
+		                                    su::to_string(end) + "/" + size);
+		resp.file_parts.push_back(BodyPart("", start, end - start + 1));
+		LOG_DEBUG(_lggr, "Serving bytes " + su::to_string(start) + "-" + su::to_string(end) + " of " +
+		                 fullFilePath);
+		return resp;
+	}
+
+	// multipart/byteranges: each part gets its own Content-Type/Content-Range
+	std::string boundary = "webserv_" + su::to_string(st.st_ino) + "_" +
+	                       su::to_string(time(NULL)) + "_" + su::to_string(conn->fd);
+	size_t content_length = 0;
+	for (size_t i = 0; i < ranges.size(); ++i) {
+		off_t start = ranges[i].first;
+		off_t end = ranges[i].second;
+		std::string part_head = "\r\n--" + boundary + "\r\nContent-Type: " + content_type +
+		                        "\r\nContent-Range: bytes " + su::to_string(start) + "-" +
+		                        su::to_string(end) + "/" + size + "\r\n\r\n";
+		resp.file_parts.push_back(BodyPart(part_head, start, end - start + 1));
+		content_length += part_head.size() + (end - start + 1);
+	}
+	std::string closing = "\r\n--" + boundary + "--\r\n";
+	resp.file_parts.push_back(BodyPart(closing, 0, 0));
+	content_length += closing.size();
+
+	resp.setContentType("multipart/byteranges; boundary=" + boundary);
+	resp.setContentLength(content_length);
+	LOG_DEBUG(_lggr, "Serving " + su::to_string(ranges.size()) + " byte ranges of " + fullFilePath);
+	return resp;
+}
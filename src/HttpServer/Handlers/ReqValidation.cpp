@@ -16,25 +16,39 @@
 #include "src/HttpServer/Structs/WebServer.hpp"
 #include "src/Utils/ServerUtils.hpp"
 
+// Name-based virtual host: pick the server of the listener from the Host header
+void WebServer::selectServer(ClientRequest &req, Connection *conn) {
+	if (!conn->vhosts)
+		return;
+	std::map<std::string, std::string>::const_iterator host = req.headers.find("host");
+	conn->servConfig = (host == req.headers.end()) ? conn->vhosts->defaultServer()
+	                                               : conn->vhosts->select(host->second);
+	if (conn->vhosts->size() > 1 && host != req.headers.end())
+		LOG_DEBUG(_lggr, "[Resp] Host " + host->second + " served by " +
+		                 (conn->servConfig->getServerNames().empty()
+		                      ? std::string("the default server")
+		                      : conn->servConfig->getServerNames()[0]));
+}
+
 bool WebServer::matchLocation(ClientRequest &req, Connection *conn) {
 	// initialize the correct locConfig // default "/"
-	_lggr.debug("Path to match : " + req.path);
-	LocConfig *match = findBestMatch(req.path, conn->servConfig->getLocations(), _lggr);
+	LOG_DEBUG(_lggr, "Path to match : " + req.path);
+	const LocConfig *match = conn->servConfig->findLocation(req.path);
 	if (!match) {
 		_lggr.error("[Resp] No matched location for : " + req.path);
 		prepareResponse(conn, Response::internalServerError(conn));
 		return false;
 	}
 	conn->locConfig = match;
-	conn->locConfig->setFullPath("");
-	_lggr.debug("[Resp] Matched location : " + conn->locConfig->path);
+	conn->full_path.clear();
+	LOG_DEBUG(_lggr, "[Resp] Matched location : " + conn->locConfig->path);
 	return true;
 }
 
 bool WebServer::normalizePath(ClientRequest &req, Connection *conn) {
 
 	// normalisation
-	_lggr.debug("full_path: " + req.path);
+	LOG_DEBUG(_lggr, "full_path: " + req.path);
 	std::string full_path = buildFullPath(req.path, conn->locConfig);
 	std::string root_full_path = buildFullPath("", conn->locConfig);
 	char resolved[PATH_MAX];
@@ -43,9 +57,9 @@ bool WebServer::normalizePath(ClientRequest &req, Connection *conn) {
 	if (su::back(normal_full_path) != '/')
 		normal_full_path += "/";
 
-	_lggr.debug("full_path: " + full_path);
-	_lggr.debug("normal_full_path: " + normal_full_path);
-	_lggr.debug("root_full_path: " + root_full_path);
+	LOG_DEBUG(_lggr, "full_path: " + full_path);
+	LOG_DEBUG(_lggr, "normal_full_path: " + normal_full_path);
+	LOG_DEBUG(_lggr, "root_full_path: " + root_full_path);
 
 	// std::string temp_full_path = normal_full_path + "/";
 	if (normal_full_path.compare(0, root_full_path.size(), root_full_path) != 0) {
@@ -53,12 +67,11 @@ bool WebServer::normalizePath(ClientRequest &req, Connection *conn) {
 		prepareResponse(conn, Response::forbidden(conn));
 		return false;
 	}
-	_lggr.debug("[Resp] Normalized full path is safe : " + normal_full_path);
+	LOG_DEBUG(_lggr, "[Resp] Normalized full path is safe : " + normal_full_path);
 	
-	// this should maybe be in the connection info, not in the locConfig
 	if (su::back(req.path) != '/' && su::back(normal_full_path) == '/')
 		normal_full_path = normal_full_path.substr(0, normal_full_path.length() - 1);
-	conn->locConfig->setFullPath(normal_full_path);
+	conn->full_path = normal_full_path;
 	return true;
 }
 
@@ -67,14 +80,14 @@ bool WebServer::processValidRequestChecks(ClientRequest &req, Connection *conn)
 
 	// check if RETURN directive in the matched location
 	if (conn->locConfig->hasReturn() && conn->locConfig->path == req.path) {
-		_lggr.info("[Resp] The matched location has a return directive.");
+		LOG_INFO(_lggr, "[Resp] The matched location has a return directive.");
 		uint16_t code = conn->locConfig->return_code;
 		std::string target = conn->locConfig->return_target;
 		prepareResponse(conn, respReturnDirective(conn, code, target));
 		return false;
 	}
 
-	_lggr.debug("[Resp] No return directive (or no exact match)");
+	LOG_DEBUG(_lggr, "[Resp] No return directive (or no exact match)");
 	
 	// method allowed?
 	if (!conn->locConfig->hasMethod(req.method)) {
@@ -83,10 +96,11 @@ bool WebServer::processValidRequestChecks(ClientRequest &req, Connection *conn)
 		prepareResponse(conn, Response::methodNotAllowed(conn, conn->locConfig->getAllowedMethodsString()));
 		return false;
 	}
-	_lggr.debug("[Resp] Method " + req.method + " is allowed (allowed: " 
-		         + conn->locConfig->getAllowedMethodsString() + ")");
+	LOG_DEBUG(_lggr, "[Resp] Method " + req.method + " is allowed (allowed: " 
+		              + conn->locConfig->getAllowedMethodsString() + ")");
 
-	if (req.content_length == -1 && req.chunked_encoding == false && req.method != "GET") {
+	if (req.content_length == -1 && req.chunked_encoding == false &&
+	    (req.method == "POST" || req.method == "PUT")) {
 		_lggr.error("No content length, not chunked");
 		prepareResponse(conn, Response(411, conn));
 		return false;
@@ -104,12 +118,12 @@ bool WebServer::processValidRequestChecks(ClientRequest &req, Connection *conn)
 		return false;
 	}
 	if (req.content_length == -1) {
-		_lggr.logWithPrefix(Logger::DEBUG, "HTTP", "No request content length -> ok.");
+		LOG_DEBUG_P(_lggr, "HTTP", "No request content length -> ok.");
 	} else {
-		_lggr.logWithPrefix(
-		    Logger::DEBUG, "HTTP",
-		    "Request content length is ok: " + su::humanReadableBytes(req.content_length) +
-		        " bytes, max is " + su::humanReadableBytes(conn->locConfig->getMaxBodySize()));
+		LOG_DEBUG_P(_lggr, "HTTP",
+		            "Request content length is ok: " +
+		                su::humanReadableBytes(req.content_length) + " bytes, max is " +
+		                su::humanReadableBytes(conn->locConfig->getMaxBodySize()));
 	}
 	return true;
 }
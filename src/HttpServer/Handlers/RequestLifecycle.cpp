@@ -17,10 +17,18 @@
 #include "src/Utils/ServerUtils.hpp"
 
 bool WebServer::handleCompleteRequest(Connection *conn) {
-    processRequest(conn);
+    conn->timing.complete = monotonicUs();
+    {
+        TraceSpan span("handler", "http", conn->fd);
+        span.detail(conn->full_path);
+        processRequest(conn);
+    }
+    // The handlers are done with the body, don't keep it until the next request
+    std::string().swap(conn->parsed_request.body);
 
-    _lggr.debug("Request was processed. Read buffer will be cleaned");
-    conn->read_buffer.clear();
+    // The read buffer only holds what followed the request, if anything
+    LOG_DEBUG(_lggr, "Request was processed, " + su::to_string(conn->read_buffer.size()) +
+                         " bytes left for the next one");
     conn->request_count++;
     conn->updateActivity();
     return true;
@@ -31,43 +39,27 @@ bool WebServer::isRequestComplete(Connection *conn) {
     switch (conn->state) {
 
     case Connection::READING_HEADERS:
-        _lggr.debug("isRequestComplete->READING_HEADERS");
+        LOG_DEBUG(_lggr, "isRequestComplete->READING_HEADERS");
         return isHeadersComplete(conn);
 
     case Connection::READING_BODY:
-        _lggr.debug("isRequestComplete->READING_BODY");
-        _lggr.debug(
-            su::to_string(conn->content_length - static_cast<ssize_t>(conn->body_data.size())) +
-            " bytes left to receive");
-
-        if (static_cast<ssize_t>(conn->body_data.size()) == conn->content_length) {
-            _lggr.debug("Read full content-length: " + su::to_string(conn->body_data.size()) +
-                        " bytes received");
-            conn->state = Connection::REQUEST_COMPLETE;
-            reconstructRequest(conn);
-            return true;
-        }
-        return false;
+        LOG_DEBUG(_lggr, "isRequestComplete->READING_BODY");
+        return isBodyComplete(conn);
 
     case Connection::READING_CHUNK_SIZE:
-        _lggr.debug("isRequestComplete->READING_CHUNK_SIZE");
-        return processChunkSize(conn);
-
     case Connection::READING_CHUNK_DATA:
-        _lggr.debug("isRequestComplete->READING_CHUNK_DATA");
-        return processChunkData(conn);
-
+    case Connection::READING_CHUNK_TRAILER:
     case Connection::READING_TRAILER:
-        _lggr.debug("isRequestComplete->READING_TRAILER");
-        return processTrailer(conn);
+        LOG_DEBUG(_lggr, "isRequestComplete->" + conn->stateToString(conn->state));
+        return decodeChunked(conn);
 
     case Connection::REQUEST_COMPLETE:
     case Connection::CHUNK_COMPLETE:
-        _lggr.debug("isRequestComplete->REQUEST_COMPLETE");
+        LOG_DEBUG(_lggr, "isRequestComplete->REQUEST_COMPLETE");
         return true;
 
     default:
-        _lggr.debug("isRequestComplete->default");
+        LOG_DEBUG(_lggr, "isRequestComplete->default");
         return false;
     }
 }
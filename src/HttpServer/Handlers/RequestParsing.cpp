@@ -17,25 +17,32 @@
 #include "src/Utils/ServerUtils.hpp"
 
 bool WebServer::isHeadersComplete(Connection *conn) {
-    _lggr.debug("isHeadersComplete");
-    std::string temp = conn->read_buffer;
+    LOG_DEBUG(_lggr, "isHeadersComplete");
     size_t header_end = conn->read_buffer.find("\r\n\r\n");
     if (header_end == std::string::npos) {
-        _lggr.debug("[HEADER CHECK] INCOMPLETE returning false");
+        LOG_DEBUG(_lggr, "[HEADER CHECK] INCOMPLETE returning false");
         return false;
     }
 
     // Headers are complete
     std::string headers = conn->read_buffer.substr(0, header_end + 4);
-    std::string remaining_data = conn->read_buffer.substr(header_end + 4);
 
-    // Header request for early headers error detection
-    ClientRequest req;
+    // Header request for early headers error detection, parsed in place: the access log
+    // needs the request line even when the headers turn out to be invalid
+    ClientRequest &req = conn->parsed_request;
+    req = ClientRequest();
     req.clfd = conn->fd;
+    if (conn->vhosts)
+        conn->servConfig = conn->vhosts->defaultServer();
+    conn->locConfig = NULL;
+    conn->full_path.clear();
 
     // On error: REQUEST_COMPLETE, Prepare Response
+    long parse_start = Tracer::enabled() ? Tracer::now() : 0;
     uint16_t error_code = RequestParsingUtils::parseRequestHeaders(headers, req, _lggr);
-    _lggr.debug("[HEADER CHECK] Status post header request parsing : " + su::to_string(error_code));
+    if (parse_start)
+        Tracer::record("parse", "http", conn->fd, parse_start, Tracer::now(), req.uri);
+    LOG_DEBUG(_lggr, "[HEADER CHECK] Status post header request parsing : " + su::to_string(error_code));
     if (error_code != 0) {
         _lggr.logWithPrefix(Logger::ERROR, "BAD REQUEST", "Malformed or invalid headers");
         prepareResponse(conn, Response(error_code, conn));
@@ -44,7 +51,20 @@ bool WebServer::isHeadersComplete(Connection *conn) {
         return true;
     }
 
-    // Match location block, Normalize URI + Check traversal
+    conn->timing.headers = monotonicUs();
+
+    // 100-continue is the only expectation there is
+    std::map<std::string, std::string>::const_iterator expect = req.headers.find("expect");
+    if (expect != req.headers.end() && !su::iequals(su::trim(expect->second), "100-continue")) {
+        _lggr.logWithPrefix(Logger::ERROR, "BAD REQUEST", "Unsupported expectation: " + expect->second);
+        prepareResponse(conn, Response(417, conn));
+        conn->state = Connection::REQUEST_COMPLETE;
+        conn->should_close = true;
+        return true;
+    }
+
+    // Virtual host, Match location block, Normalize URI + Check traversal
+    selectServer(req, conn);
     if (!matchLocation(req, conn) || !normalizePath(req, conn)) {
         conn->state = Connection::REQUEST_COMPLETE;
         conn->should_close = true;
@@ -56,114 +76,87 @@ bool WebServer::isHeadersComplete(Connection *conn) {
         conn->should_close = true;
         return true;
     }
-    // Valid request headers - store parsed headers in connection
-    conn->headers_buffer = headers;
-    conn->parsed_request = req;
+    conn->timing.routed = monotonicUs();
+    Tracer::record("route", "http", conn->fd, conn->timing.headers, conn->timing.routed,
+                   conn->locConfig->getPath());
+    // Multipart POST to an upload location: the body goes to files as it arrives
+    if (!startUpload(req, conn)) {
+        conn->state = Connection::REQUEST_COMPLETE;
+        conn->should_close = true;
+        return true;
+    }
+
+    // Valid request headers: what follows them is body (or chunked framing)
     conn->chunked = req.chunked_encoding;
     conn->content_length = req.content_length;
+    size_t body_start = header_end + 4;
+    sendContinue(req, conn, body_start);
 
-    if (!conn->chunked) { // Store remaining data as binary body data for Content-Length requests
-
-        if (!remaining_data.empty() && conn->content_length > 0) {
-            conn->body_data.insert(conn->body_data.end(),
-                                   reinterpret_cast<const unsigned char *>(remaining_data.data()),
-                                   reinterpret_cast<const unsigned char *>(remaining_data.data() +
-                                                                           remaining_data.size()));
-            conn->body_bytes_read = conn->body_data.size();
-        }
-        _lggr.debug("Request POST HEADER content length: " + su::to_string(conn->content_length));
-        _lggr.debug("Request POST HEADER remaining data size: " +
-                    su::to_string(remaining_data.size()));
-
-        // ERROR handling if Body present when it should not
-        if (conn->content_length <= 0 && conn->body_bytes_read != 0) {
-            _lggr.error("Body present when it should not (400)");
-            prepareResponse(conn, Response(400, conn));
-            conn->should_close = true;
-            conn->state = Connection::REQUEST_COMPLETE;
-            return true;
-        }
-
-        // Case : content_length 0 or no content length)
-        if (conn->content_length <= 0) {
-            conn->state = Connection::REQUEST_COMPLETE;
-            return true;
-        }
-        // Case : content_length specified
-        else { // if (conn->content_length > 0)
-            conn->state = Connection::READING_BODY;
-            // check if full body
-            if (static_cast<ssize_t>(conn->body_data.size()) == conn->content_length) {
-                conn->state = Connection::REQUEST_COMPLETE;
-                // req.body = reconstructRequest(conn);
-                _lggr.debug("1 req.body" + req.body);
-                return true;
-            }
-            if (static_cast<ssize_t>(conn->body_data.size()) > conn->content_length) {
-                conn->state = Connection::REQUEST_COMPLETE;
-                prepareResponse(conn, Response(400));
-                _lggr.error("Content length mismatch: " + req.body);
-                conn->should_close = true;
-                return true;
-            }
-            // clear read_buffer since body data is in body_data vector
-            conn->read_buffer.clear();
-            return false;
-        }
-    }
-
-    else { // CHUNKED - store remaining data as string
+    if (conn->chunked) {
+        conn->read_buffer.erase(0, body_start);
         conn->state = Connection::READING_CHUNK_SIZE;
-        conn->read_buffer = remaining_data; // Keep any data after headers for chunk processing
-        conn->chunk_size = 0;
-        conn->chunk_bytes_read = 0;
-        conn->chunk_data.clear();
-        return processChunkSize(conn);
+        conn->chunks.reset();
+        conn->body.clear();
+        return decodeChunked(conn);
     }
-    // Default
-    _lggr.logWithPrefix(Logger::ERROR, "BAD REQUEST", "Impossible request");
-    conn->state = Connection::REQUEST_COMPLETE;
-    return true;
-}
 
-bool WebServer::reconstructRequest(Connection *conn) {
-    std::string reconstructed_request;
+    LOG_DEBUG(_lggr, "Request POST HEADER content length: " + su::to_string(conn->content_length));
+    LOG_DEBUG(_lggr, "Request POST HEADER remaining data size: " +
+                     su::to_string(conn->read_buffer.size() - body_start));
 
-    if (conn->headers_buffer.empty()) {
-        _lggr.warn("Cannot reconstruct request: headers not available");
-        return false;
+    // Anything past the body is the next request, it is parsed as such in its turn
+    if (conn->content_length <= 0) {
+        conn->read_buffer.erase(0, body_start);
+        conn->state = Connection::REQUEST_COMPLETE;
+        return true;
     }
 
-    reconstructed_request = conn->headers_buffer;
-
-    if (conn->content_length > 0) {
-        size_t body_size =
-            std::min(static_cast<size_t>(conn->content_length), conn->body_data.size());
+    // The size is validated against client_max_body_size: allocate the body once
+    if (!conn->upload && !conn->locConfig->infiniteBodySize())
+        conn->body.reserve(conn->content_length);
+    size_t taken = std::min(conn->read_buffer.size() - body_start, conn->bodyLeft());
+    bool stored = conn->appendBody(conn->read_buffer.data() + body_start, taken);
+    conn->read_buffer.erase(0, body_start + taken);
+    conn->state = Connection::READING_BODY;
+    if (!stored)
+        return uploadError(conn);
+    return isBodyComplete(conn);
+}
 
-        reconstructed_request.append(reinterpret_cast<const char *>(&conn->body_data[0]),
-                                     body_size);
+void WebServer::sendContinue(const ClientRequest &req, Connection *conn, size_t body_start) {
+    if (!req.headers.count("expect") || req.version != "HTTP/1.1" ||
+        (!conn->chunked && conn->content_length <= 0) || conn->read_buffer.size() > body_start)
+        return;
+    // Nothing is queued before the final response, the socket buffer is empty
+    std::string interim = Response::continue_().toString();
+    ssize_t sent = send(conn->fd, interim.data(), interim.size(), MSG_NOSIGNAL);
+    if (sent != static_cast<ssize_t>(interim.size()))
+        _lggr.error("Failed to send 100 Continue to fd: " + su::to_string(conn->fd));
+    else
+        LOG_DEBUG(_lggr, "Sent 100 Continue to fd: " + su::to_string(conn->fd));
+}
 
-        _lggr.debug("Reconstructed request with " + su::to_string(body_size) +
-                    " bytes of body data");
+bool WebServer::isBodyComplete(Connection *conn) {
+    size_t expected = static_cast<size_t>(conn->content_length);
+    if (conn->body_received < expected) {
+        LOG_DEBUG(_lggr, su::to_string(expected - conn->body_received) + " bytes left to receive");
+        return false;
     }
-
-    conn->read_buffer = reconstructed_request;
-
-    size_t headers_end = conn->headers_buffer.size();
-    std::string debug_output =
-        "Reconstructed request headers:\n" + conn->read_buffer.substr(0, headers_end);
-    if (conn->content_length > 0) {
-        debug_output += "\n[Binary body data: " + su::to_string(conn->body_data.size()) + " bytes]";
+    if (conn->body_received > expected) {
+        _lggr.error("Content length mismatch: " + su::to_string(conn->body_received) +
+                    " bytes received, " + su::to_string(expected) + " announced");
+        prepareResponse(conn, Response(400, conn));
+        conn->should_close = true;
     }
-
+    conn->state = Connection::REQUEST_COMPLETE;
     return true;
 }
 
 // Deprecated
 bool WebServer::parseRequest(Connection *conn, ClientRequest &req) {
-    _lggr.debug("Parsing request: " + conn->read_buffer);
+    LOG_DEBUG(_lggr, "Parsing request: " + conn->read_buffer);
     uint16_t error_code = RequestParsingUtils::parseRequest(conn->read_buffer, req, _lggr);
-    _lggr.debug("Error code post request parsing : " + su::to_string(error_code));
+    LOG_DEBUG(_lggr, "Error code post request parsing : " + su::to_string(error_code));
     if (error_code != 0) {
         _lggr.error("Parsing of the request failed.");
         prepareResponse(conn, Response(error_code, conn));
@@ -17,55 +17,44 @@
 #include "src/Utils/ServerUtils.hpp"
 
 void WebServer::processRequest(Connection *conn) {
-    _lggr.info("Processing request from fd: " + su::to_string(conn->fd));
+    LOG_INFO(_lggr, "Processing request from fd: " + su::to_string(conn->fd));
 
-    ClientRequest req = conn->parsed_request;
+    // The body moves from the connection to the request, either framing
+    ClientRequest &req = conn->parsed_request;
+    req.body.swap(conn->body);
+    LOG_DEBUG(_lggr, "Request body: " + su::to_string(req.body.size()) + " bytes");
 
-    // Handle body extraction differently for chunked vs non-chunked
-    if (req.chunked_encoding) {
-        // For chunked requests, use the reconstructed chunk data
-        req.body = conn->chunk_data;
-        _lggr.debug("Using chunked body data: " + su::to_string(req.body.length()) + " bytes");
-    } else if (!req.chunked_encoding && conn->headers_buffer.size() <= conn->read_buffer.size()) {
-        req.body = conn->read_buffer.substr(conn->headers_buffer.size());
-    } else {
-        _lggr.debug("No body data or headers not properly parsed");
-        req.body = "";
-    }
-
-    _lggr.debug("req.body: " + req.body);
-    _lggr.debug("req.headers: " + conn->headers_buffer);
-    _lggr.debug("req.uri: " + req.uri);
-
-    // For chunked requests: use of chunk_data length for content verification
-    size_t actual_body_size = req.chunked_encoding ? conn->chunk_data.size() : req.body.size();
-
-    _lggr.debug("[Resp] Payload vs content size: " + su::to_string(req.content_length) +
-                ", payload size: " + su::to_string(actual_body_size));
-
-    // Only verify content-length for non-chunked requests
-    if (!req.chunked_encoding && req.content_length >= 0 &&
-        static_cast<ssize_t>(actual_body_size) != req.content_length) {
-        _lggr.error("[Resp] Payload mismatch, content size: " + su::to_string(req.content_length) +
-                    ", payload size: " + su::to_string(actual_body_size));
-        prepareResponse(conn, Response::contentTooLarge(conn));
-        return;
-    }
-
-    _lggr.debug("FD " + su::to_string(req.clfd) + " ClientRequest {" + req.toString() + "}");
+    LOG_DEBUG(_lggr, "FD " + su::to_string(req.clfd) + " ClientRequest {" + req.toString() + "}");
     // process the request
     processValidRequest(req, conn);
 }
 
 void WebServer::processValidRequest(ClientRequest &req, Connection *conn) {
 
-    const std::string &full_path = conn->locConfig->getFullPath();
-    _lggr.debug("[Resp] The matched location is an exact match: " +
-                su::to_string(conn->locConfig->is_exact_()));
+    // native upload, the files are already written
+    if (conn->upload) {
+        prepareResponse(conn, req.method == "PUT" ? respPut(req, conn) : respUpload(conn));
+        return;
+    }
+    if (req.method == "DELETE" && conn->locConfig->uploadOn() &&
+        !conn->locConfig->acceptExtension(getExtension(conn->full_path))) {
+        prepareResponse(conn, respDelete(req, conn));
+        return;
+    }
+
+    // metrics page, nothing on disk to look at
+    if (conn->locConfig->stub_status != STATUS_OFF) {
+        prepareResponse(conn, respStubStatus(conn));
+        return;
+    }
+
+    const std::string &full_path = conn->full_path;
+    LOG_DEBUG(_lggr, "[Resp] The matched location is an exact match: " +
+                     su::to_string(conn->locConfig->is_exact_()));
 
     // File system check
     FileType file_type = checkFileType(full_path);
-    _lggr.debug("[Resp] checkFileType for " + full_path + " is " + fileTypeToString(file_type));
+    LOG_DEBUG(_lggr, "[Resp] checkFileType for " + full_path + " is " + fileTypeToString(file_type));
 
     if (file_type == NOT_FOUND_404 && su::back(full_path) == '/') {
         std::string pathWithoutSlash = full_path.substr(0, full_path.length() - 1);
@@ -11,6 +11,7 @@
 /* ************************************************************************** */
 
 #include "src/HttpServer/HttpServer.hpp"
+#include "src/HttpServer/Structs/BodyStream.hpp"
 #include "src/HttpServer/Structs/Connection.hpp"
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/HttpServer/Structs/WebServer.hpp"
@@ -21,88 +22,221 @@ ssize_t WebServer::prepareResponse(Connection *conn, const Response &resp) {
 		    "Trying to prepare a response for a connection that is ready to send another one");
 		_lggr.error("Current response: " + conn->response.toShortString());
 		_lggr.error("Trying to prepare response: " + resp.toShortString());
+		if (resp.hasFileBody())
+			close(resp.file_fd);
+		delete resp.stream;
 		return -1;
 	}
-	_lggr.debug("Saving a response [" + su::to_string(resp.status_code) + "] for fd " +
-	            su::to_string(conn->fd));
-	_lggr.debug("Response :" + resp.toShortString());
+	LOG_DEBUG(_lggr, "Saving a response [" + su::to_string(resp.status_code) + "] for fd " +
+	                 su::to_string(conn->fd));
+	LOG_DEBUG(_lggr, "Response :" + resp.toShortString());
 	conn->response = resp;
 	conn->response_ready = true;
+	conn->timing.ready = monotonicUs();
 	return conn->response.toString().size();
 }
 
-bool WebServer::sendResponse(Connection *conn) {
-	std::string raw_response;
+// Phases finished before serialization, in milliseconds; send is still to come
+static std::string serverTiming(const RequestTiming &timing) {
+	long durations[PHASE_COUNT];
+	std::string value;
+	char buf[64];
+
+	timing.phases(durations);
+	for (int i = 0; i < PHASE_SEND; ++i) {
+		if (durations[i] < 0)
+			continue;
+		std::snprintf(buf, sizeof(buf), "%s%s;dur=%.3f", value.empty() ? "" : ", ",
+		              RequestTiming::phaseName(i), durations[i] / 1e3);
+		value += buf;
+	}
+	return value;
+}
+
+// Serializes the prepared response into the connection's send queue
+void WebServer::queueResponse(Connection *conn) {
+	conn->send_queue.clear();
+	conn->send_offset = 0;
+	conn->sending = true;
+	conn->bytes_sent = 0;
 
-	_lggr.debug("Current state of response [" + conn->response.toShortString());
-	_lggr.debug("Sending response [" + conn->response.toShortString() +
-	            "] back to fd: " + su::to_string(conn->fd));
-	std::cout << conn->response.toShortString() << "] back to fd: " << su::to_string(conn->fd) << std::endl;
-	
 	if (conn->cgi_response != "") {
-		raw_response = conn->cgi_response;
+		conn->send_queue.push_back(BodyPart(conn->cgi_response, 0, 0));
 		conn->cgi_response = "";
-	} else {
-		raw_response = conn->response.toString();
-		conn->response.reset();
+		return;
+	}
+	applyContentEncoding(conn);
+	if (conn->locConfig && conn->locConfig->serverTimingOn())
+		conn->response.setHeader("Server-Timing", serverTiming(conn->timing));
+	if (_draining) {
+		// last response on this connection, the process is going away
+		conn->response.setHeader("Connection", "close");
+		conn->keep_persistent_connection = false;
+	} else if (conn->should_close) {
+		// refused mid-request, what is left of it can't be told from the next one
+		conn->response.setHeader("Connection", "close");
 	}
-	bool send_success = send(conn->fd, raw_response.c_str(), raw_response.size(), MSG_NOSIGNAL) != -1;
-	if (!send_success) {
-		return false;
+	if (!conn->response.hasFileBody()) {
+		conn->send_queue.push_back(BodyPart(conn->response.toString(), 0, 0));
+		return;
 	}
+	conn->send_queue.push_back(BodyPart(conn->response.toStringHeadersOnly(), 0, 0));
+	conn->send_queue.insert(conn->send_queue.end(), conn->response.file_parts.begin(),
+	                        conn->response.file_parts.end());
+}
 
+bool WebServer::sendResponse(Connection *conn) {
+	TraceSpan span("send", "net", conn->fd);
+	if (!conn->sending) {
+		LOG_DEBUG(_lggr, "Sending response [" + conn->response.toShortString() +
+		                 "] back to fd: " + su::to_string(conn->fd));
+		queueResponse(conn);
+	}
+
+	size_t pulls = 0;
+	for (;;) {
+		if (conn->send_queue.empty()) {
+			if (!conn->response.hasStream())
+				break;
+			// bounded work per event: EPOLLOUT is level-triggered and fires again
+			if (pulls++ == STREAM_PULLS_PER_EVENT)
+				return true;
+			if (!conn->pullStream()) {
+				_lggr.error("Body stream failed for fd: " + su::to_string(conn->fd));
+				return false;
+			}
+			continue;
+		}
+		BodyPart &part = conn->send_queue.front();
+		ssize_t sent;
+
+		if (conn->send_offset < part.data.size()) {
+			// a file range follows: let the kernel put both in the same segment
+			int more = part.length ? MSG_MORE : 0;
+			sent = send(conn->fd, part.data.data() + conn->send_offset,
+			            part.data.size() - conn->send_offset, MSG_NOSIGNAL | more);
+		} else {
+			size_t file_sent = conn->send_offset - part.data.size();
+			off_t offset = part.offset + static_cast<off_t>(file_sent);
+			sent = sendfile(conn->fd, conn->response.file_fd, &offset, part.length - file_sent);
+			if (sent == 0) {
+				_lggr.error("File shrank while being sent to fd: " + su::to_string(conn->fd));
+				return false;
+			}
+		}
+		if (sent == -1) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return true; // socket buffer full, wait for the next EPOLLOUT
+			return false;
+		}
+		conn->send_offset += sent;
+		conn->bytes_sent += sent;
+		if (conn->send_offset == part.data.size() + part.length) {
+			conn->send_queue.pop_front();
+			conn->send_offset = 0;
+		}
+	}
+
+	conn->timing.done = monotonicUs();
+	logAccess(conn);
+	recordMetrics(conn);
+	conn->releaseResponse();
 	epollManage(EPOLL_CTL_MOD, conn->fd, EPOLLIN);
 	conn->response_ready = false;
-	conn->state = Connection::READING_HEADERS;
+	conn->resetForNewRequest();
 	return true;
 }
 
 // Serving the index file or listing if possible
 Response WebServer::respDirectoryRequest(Connection *conn, const std::string &fullDirPath) {
-	_lggr.debug("Handling directory request: " + fullDirPath);
+	LOG_DEBUG(_lggr, "Handling directory request: " + fullDirPath);
 
 	// Try to serve index file
 	if (!conn->locConfig->index.empty()) {
 		std::string fullIndexPath = fullDirPath + conn->locConfig->index;
-		_lggr.debug("Trying index file: " + fullIndexPath);
+		LOG_DEBUG(_lggr, "Trying index file: " + fullIndexPath);
 		if (checkFileType(fullIndexPath.c_str()) == ISREG) {
-			_lggr.debug("Found index file, serving: " + fullIndexPath);
+			LOG_DEBUG(_lggr, "Found index file, serving: " + fullIndexPath);
 			return respFileRequest(conn, fullIndexPath);
 		}
 	}
 
 	// Handle autoindex
 	if (conn->locConfig->autoindex) {
-		_lggr.debug("Autoindex on, generating directory listing");
+		LOG_DEBUG(_lggr, "Autoindex on, generating directory listing");
 		return generateDirectoryListing(conn, fullDirPath);
 	}
 
 	// No index file and no autoindex
-	_lggr.debug("No index file, autoindex disabled");
+	LOG_DEBUG(_lggr, "No index file, autoindex disabled");
 	return Response::notFound(conn);
 }
 
 // serving the file if found
 Response WebServer::respFileRequest(Connection *conn, const std::string &fullFilePath) {
-	_lggr.debug("Handling file request: " + fullFilePath);
-	// Read file content
-	std::string content = getFileContent(fullFilePath);
-	// this check is redondant as it has already been checked
-	if (content.empty()) {
-		_lggr.error("Failed to read file: " + fullFilePath);
+	LOG_DEBUG(_lggr, "Handling file request: " + fullFilePath);
+
+	// gzip_static: serve a precompressed sibling as-is when the client takes gzip
+	std::string servedPath = fullFilePath;
+	bool precompressed = false;
+	if (conn->locConfig->gzipStaticOn() && checkFileType((fullFilePath + ".gz").c_str()) == ISREG) {
+		precompressed = acceptsGzip(conn->parsed_request);
+		if (precompressed)
+			servedPath = fullFilePath + ".gz";
+	}
+
+	TraceSpan span("open", "fs", conn->fd);
+	span.detail(servedPath);
+	int fd = open(servedPath.c_str(), O_RDONLY);
+	if (fd == -1) {
+		_lggr.error("Failed to open file: " + servedPath);
 		return Response::notFound(conn);
 	}
-	// Create response
-	Response resp(200, content);
-	resp.setContentType(detectContentType(fullFilePath));
-	resp.setContentLength(content.length());
-	_lggr.debug("Successfully serving file: " + fullFilePath + " (" +
-	            su::to_string(content.length()) + " bytes)");
+	struct stat st;
+	if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+		_lggr.error("Failed to stat file: " + servedPath);
+		close(fd);
+		return Response::internalServerError(conn);
+	}
+
+	// Range / If-Range: serve only the requested byte ranges
+	const std::map<std::string, std::string> &headers = conn->parsed_request.headers;
+	std::map<std::string, std::string>::const_iterator range = headers.find("range");
+	if (range != headers.end() && ifRangeMatches(conn->parsed_request, st)) {
+		std::vector<std::pair<off_t, off_t> > ranges;
+		RangeStatus status = parseByteRanges(range->second, st.st_size, ranges);
+		if (status != RANGE_NONE) {
+			Response resp = respRangeRequest(conn, fd, st, fullFilePath, ranges);
+			if (precompressed && resp.status_code == 206)
+				resp.setHeader("Content-Encoding", "gzip");
+			if (conn->locConfig->gzipStaticOn())
+				resp.setHeader("Vary", "Accept-Encoding");
+			return resp;
+		}
+		LOG_DEBUG(_lggr, "Ignoring invalid Range header: " + range->second);
+	}
+
+	Response resp(200);
+	resp.setContentType(detectContentType(conn->config->mimeTypes(), fullFilePath,
+	                                      conn->locConfig->getDefaultType()));
+	resp.setContentLength(st.st_size);
+	resp.setHeader("Accept-Ranges", "bytes");
+	resp.setHeader("Last-Modified", httpDate(st.st_mtime));
+	resp.setHeader("ETag", makeETag(st));
+	if (precompressed)
+		resp.setHeader("Content-Encoding", "gzip");
+	if (conn->locConfig->gzipStaticOn())
+		resp.setHeader("Vary", "Accept-Encoding");
+	resp.file_fd = fd;
+	if (st.st_size > 0)
+		resp.file_parts.push_back(BodyPart("", 0, st.st_size));
+	LOG_DEBUG(_lggr, "Successfully serving file: " + servedPath + " (" +
+	                 su::to_string(st.st_size) + " bytes)");
 	return resp;
 }
 
 Response WebServer::respReturnDirective(Connection *conn, uint16_t code, std::string target) {
-	_lggr.debug("Handling return directive '" + su::to_string(code) + "' to " + target);
+	LOG_DEBUG(_lggr, "Handling return directive '" + su::to_string(code) + "' to " + target);
 
 	if (code > 399)
 		return Response(code, conn);
@@ -123,7 +257,7 @@ Response WebServer::respReturnDirective(Connection *conn, uint16_t code, std::st
 	resp.body = html.str();
 	resp.setContentType("text/html");
 	resp.setContentLength(resp.body.length());
-	_lggr.debug("Generated redirect response");
+	LOG_DEBUG(_lggr, "Generated redirect response");
 
 	return resp;
 }
@@ -14,6 +14,7 @@
 #include "src/HttpServer/Structs/Connection.hpp"
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/HttpServer/Structs/WebServer.hpp"
+#include "src/Utils/ServerUtils.hpp"
 
 void printCGIResponse(const std::string &cgi_output) {
 	std::istringstream response_stream(cgi_output);
@@ -35,36 +36,47 @@ void printCGIResponse(const std::string &cgi_output) {
 	}
 }
 
+// CGI scripts print their status code on the first line, then a blank line
+// and the HTML body
 bool WebServer::prepareCGIResponse(CGI *cgi, Connection *conn) {
 	Logger logger;
 	std::string cgi_output;
 	char buffer[4096];
 	ssize_t bytes_read;
 	int resp_code = 200;
+	TraceSpan span("cgi read", "cgi", conn->fd);
 
-	while ((bytes_read = read(cgi->getOutputFd(), buffer, sizeof(buffer))) > 0) {
+	while ((bytes_read = read(cgi->getOutputFd(), buffer, sizeof(buffer))) > 0)
 		cgi_output.append(buffer, bytes_read);
-		if (cgi_output.size() > 5) {
-			std::string s = cgi_output.substr(2, 3);
-			std::stringstream ss(s);
-			ss >> resp_code;
-			if (resp_code > 201) {
-				close(cgi->getOutputFd());
-				return (prepareResponse(conn, Response(resp_code)));
-			}
-		}
-	}
 
 	// Close cgi script fd
 	close(cgi->getOutputFd());
+	conn->timing.cgi_done = monotonicUs();
 
 	if (bytes_read == -1) {
 		logger.logWithPrefix(Logger::ERROR, "CGI", "Error reading from CGI script");
+		++_metrics.cgi_failed;
 		return (false);
 	}
-	std::string resp_body = cgi_output.substr(7);
+	size_t eol = cgi_output.find('\n');
+	std::stringstream ss(cgi_output.substr(0, eol));
+	if (!(ss >> resp_code) || resp_code < 100 || resp_code > 599) {
+		++_metrics.cgi_failed;
+		return (prepareResponse(conn, Response::badGateway(conn)) > 0);
+	}
+	if (resp_code > 201)
+		return (prepareResponse(conn, Response(resp_code, conn)) > 0);
+
+	std::string resp_body = (eol == std::string::npos) ? "" : cgi_output.substr(eol + 1);
+	if (su::starts_with(resp_body, "\r\n"))
+		resp_body.erase(0, 2);
+	else if (su::starts_with(resp_body, "\n"))
+		resp_body.erase(0, 1);
 	//printCGIResponse(resp_body);
-	return (prepareResponse(conn, Response(resp_code, resp_body)) > 0);
+	Response resp(resp_code, resp_body);
+	resp.setContentType("text/html");
+	resp.setContentLength(resp_body.size());
+	return (prepareResponse(conn, resp) > 0);
 }
 
 void WebServer::handleCGIOutput(int fd) {
@@ -0,0 +1,70 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Shutdown.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:41:09 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 14:41:09 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/CGI/CGI.hpp"
+#include "src/HttpServer/HttpServer.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/WebServer.hpp"
+
+void WebServer::startDraining() {
+	if (_draining)
+		return;
+	_draining = true;
+	_drain_deadline = time(NULL) + drain_timeout;
+
+	// stop accepting; after an upgrade the new process holds its own copy of the sockets
+	const std::map<int, VirtualHosts> &listeners = _config->listeners();
+	for (std::map<int, VirtualHosts>::const_iterator it = listeners.begin();
+	     it != listeners.end(); ++it) {
+		epollManage(EPOLL_CTL_DEL, it->first, 0);
+		close(it->first);
+	}
+	for (std::vector<ServerConfig>::iterator it = _confs.begin(); it != _confs.end(); ++it)
+		it->setServerFD(-1);
+
+	// idle keep-alive and lingering connections have nothing in flight
+	std::vector<Connection *> idle;
+	for (std::map<int, Connection *>::iterator it = _connections.begin();
+	     it != _connections.end(); ++it) {
+		Connection *conn = it->second;
+		if ((conn->state == Connection::READING_HEADERS && conn->read_buffer.empty() &&
+		     !conn->response_ready) || conn->state == Connection::LINGERING)
+			idle.push_back(conn);
+	}
+	for (size_t i = 0; i < idle.size(); ++i)
+		closeConnection(idle[i]);
+	LOG_INFO(_lggr, "Draining: " + su::to_string(_connections.size()) + " connection(s) and " +
+	                su::to_string(_cgi_pool.size()) + " CGI(s) left to finish, within " +
+	                su::to_string(drain_timeout) + "s");
+}
+
+bool WebServer::isDrained() const {
+	return _draining && _connections.empty() && _cgi_pool.empty();
+}
+
+bool WebServer::drainTimedOut() const {
+	return _draining && time(NULL) >= _drain_deadline;
+}
+
+void WebServer::killCGIs() {
+	for (std::map<int, std::pair<CGI *, Connection *> >::iterator it = _cgi_pool.begin();
+	     it != _cgi_pool.end(); ++it) {
+		CGI *cgi = it->second.first;
+		if (cgi->getPid() > 0) {
+			kill(cgi->getPid(), SIGKILL);
+			waitpid(cgi->getPid(), NULL, 0);
+		}
+		close(it->first);
+		delete cgi;
+	}
+	_cgi_pool.clear();
+}
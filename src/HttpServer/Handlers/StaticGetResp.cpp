@@ -11,6 +11,7 @@
 /* ************************************************************************** */
 
 #include "src/HttpServer/HttpServer.hpp"
+#include "src/HttpServer/Structs/DirListing.hpp"
 #include "src/HttpServer/Structs/Connection.hpp"
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/HttpServer/Structs/WebServer.hpp"
@@ -38,12 +39,12 @@ bool WebServer::handleFileSystemErrors(FileType file_type, const std::string &fu
 
 void WebServer::handleDirectoryRequest(ClientRequest &req, Connection *conn, bool end_slash) {
 
-	const std::string full_path = conn->locConfig->getFullPath();
+	const std::string full_path = conn->full_path;
 
-	_lggr.debug("Directory request: " + full_path);
+	LOG_DEBUG(_lggr, "Directory request: " + full_path);
 
 	if (!end_slash) {
-		_lggr.info("Directory request without trailing slash, redirecting to : " + req.path + "/");
+		LOG_INFO(_lggr, "Directory request without trailing slash, redirecting to : " + req.path + "/");
 		std::string redirectPath = req.path + "/";
 		prepareResponse(conn, respReturnDirective(conn, 301, redirectPath));
 		return;
@@ -55,12 +56,12 @@ void WebServer::handleDirectoryRequest(ClientRequest &req, Connection *conn, boo
 
 void WebServer::handleFileRequest(ClientRequest &req, Connection *conn, bool end_slash) {
 
-	const std::string full_path = conn->locConfig->getFullPath();
-	_lggr.debug("File request: " + full_path);
+	const std::string full_path = conn->full_path;
+	LOG_DEBUG(_lggr, "File request: " + full_path);
 
 	// Trailing '/'? Redirect
 	if (end_slash) { //&& !conn->locConfig->is_exact_()
-		_lggr.info("File request with trailing slash, redirecting: " + req.path);
+		LOG_INFO(_lggr, "File request with trailing slash, redirecting: " + req.path);
 		std::string redirectPath = req.path.substr(0, req.path.length() - 1);
 		prepareResponse(conn, respReturnDirective(conn, 301, redirectPath));
 		return;
@@ -70,7 +71,7 @@ void WebServer::handleFileRequest(ClientRequest &req, Connection *conn, bool end
 	std::string extension = getExtension(full_path);
 	if (conn->locConfig->acceptExtension(extension)) {
 		std::string interpreter = conn->locConfig->getInterpreter(extension);
-		_lggr.debug("CGI request, interpreter location : " + interpreter);
+		LOG_DEBUG(_lggr, "CGI request, interpreter location : " + interpreter);
 		req.extension = extension;
 		uint16_t exit_code = handleCGIRequest(req, conn);
 		if (exit_code) {
@@ -82,7 +83,7 @@ void WebServer::handleFileRequest(ClientRequest &req, Connection *conn, bool end
 
 	// HANDLE STATIC GET RESPONSE
 	if (req.method == "GET") {
-		_lggr.debug("Static file GET request");
+		LOG_DEBUG(_lggr, "Static file GET request");
 		prepareResponse(conn, respFileRequest(conn, full_path));
 		return;
 	} else {
@@ -94,87 +95,59 @@ void WebServer::handleFileRequest(ClientRequest &req, Connection *conn, bool end
 }
 
 Response WebServer::generateDirectoryListing(Connection *conn, const std::string &fullDirPath) {
-    _lggr.debug("Generating directory listing for: " + fullDirPath);
+    LOG_DEBUG(_lggr, "Generating directory listing for: " + fullDirPath);
+    TraceSpan span("listing", "fs", conn->fd);
+    span.detail(fullDirPath);
 
     // Open directory
     DIR *dir = opendir(fullDirPath.c_str());
-    if (dir == NULL) {
+    struct stat dirStat;
+    if (dir == NULL || fstat(dirfd(dir), &dirStat) == -1) {
         _lggr.error("Failed to open directory: " + fullDirPath + " - " +
                     std::string(strerror(errno)));
+        if (dir != NULL)
+            closedir(dir);
         return Response::notFound(conn);
     }
 
-    // Generate HTML content
-    std::ostringstream htmlContent;
-    struct dirent *entry;
-    htmlContent << "<!DOCTYPE html>\n"
-                << "<html lang=\"en\">\n"
-                << "<head>\n"
-                << "<meta charset=\"UTF-8\">\n"
-                << "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">\n"
-                << "<title>Directory Listing - " << fullDirPath << "</title>\n"
-                << "<link rel=\"stylesheet\" href=\"/styles.css\">\n"
-                << "</head>\n<body>\n"
-                << "<div class=\"container\">\n"
-                << "<h1 class=\"title\">Directory Listing</h1>\n"
-                << "<p class=\"subtitle\">" << fullDirPath << "</p>\n"
-                << "<table>\n<tr><th>Name</th><th>Type</th><th>Size</th></tr>\n";
-
-    while ((entry = readdir(dir)) != NULL) {
-        std::string filename = entry->d_name;
-        if (filename == ".")
-            continue;
-
-        std::string fullPath = fullDirPath;
-        if (su::back(fullPath) != '/')
-            fullPath += "/";
-        fullPath += filename;
-
-        struct stat fileStat;
-        htmlContent << "<tr><td><a href=\"" << filename;
-        if (stat(fullPath.c_str(), &fileStat) == 0) {
-            if (S_ISDIR(fileStat.st_mode)) {
-                htmlContent << "/\" class=\"dir\">";
-            } else {
-                htmlContent << "\" class=\"file\">";
+    bool json = conn->locConfig->autoindex_json;
+    std::string contentType = json ? "application/json" : "text/html";
+    std::string key = (json ? "json:" : "html:") + fullDirPath;
+
+    // Unchanged directory: reuse the page generated last time
+    const std::string *cached = _listingCache.find(key, dirStat);
+    if (cached != NULL) {
+        closedir(dir);
+        Response resp(200, *cached);
+        resp.setContentType(contentType);
+        resp.setContentLength(cached->length());
+        LOG_DEBUG(_lggr, "Serving cached directory listing (" + su::to_string(cached->length()) +
+                         " bytes)");
+        return resp;
+    }
+
+    Response resp(200);
+    resp.setContentType(contentType);
+    DirListingStream *listing =
+        new DirListingStream(dir, fullDirPath, json, &_listingCache, key, dirStat);
+
+    // HTTP/1.0 has no chunked encoding: build the page in memory
+    if (conn->parsed_request.version != "HTTP/1.1") {
+        while (!listing->done()) {
+            if (!listing->next(resp.body)) {
+                delete listing;
+                return Response::internalServerError(conn);
             }
-            htmlContent << filename << "</a></td><td>";
-            if (S_ISDIR(fileStat.st_mode))
-                htmlContent << "<span class=\"dir\">Directory</span>";
-            else if (S_ISREG(fileStat.st_mode))
-                htmlContent << "<span class=\"file\">File</span>";
-            else
-                htmlContent << "Other";
-
-            htmlContent << "</td><td class=\"size\">";
-            if (S_ISREG(fileStat.st_mode))
-                htmlContent << su::to_string(fileStat.st_size);
-            else
-                htmlContent << "-";
-            htmlContent << "</td></tr>\n";
-        } else {
-            htmlContent << "\">" << filename << "</a></td><td>Unknown</td><td>-</td></tr>\n";
         }
+        delete listing;
+        resp.setContentLength(resp.body.length());
+        LOG_DEBUG(_lggr, "Generated directory listing (" + su::to_string(resp.body.length()) +
+                         " bytes)");
+        return resp;
     }
 
-    htmlContent << "</table>\n"
-                << "<footer>Generated by WebServer " << __WEBSERV_VERSION__ << "</footer>\n"
-                << "</div>\n"
-                << "<div class=\"floating-elements\">\n"
-                << "<div class=\"floating-element\"></div>\n"
-                << "<div class=\"floating-element\"></div>\n"
-                << "<div class=\"floating-element\"></div>\n"
-                << "</div>\n"
-                << "</body>\n</html>";
-
-    closedir(dir);
-
-    // Create response
-    std::string body = htmlContent.str();
-    Response resp(200, body);
-    resp.setContentType("text/html");
-    resp.setContentLength(body.length());
-
-    _lggr.debug("Generated directory listing (" + su::to_string(body.length()) + " bytes)");
+    resp.stream = listing;
+    resp.setHeader("Transfer-Encoding", "chunked");
+    LOG_DEBUG(_lggr, "Streaming directory listing");
     return resp;
 }
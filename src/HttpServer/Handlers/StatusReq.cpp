@@ -0,0 +1,74 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   StatusReq.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:48:12 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 14:48:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/HttpServer.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/Response.hpp"
+#include "src/HttpServer/Structs/WebServer.hpp"
+#include "src/Utils/ServerUtils.hpp"
+
+void WebServer::recordMetrics(Connection *conn) {
+	const ServerConfig *server = conn->servConfig;
+	if (server == NULL && conn->vhosts)
+		server = conn->vhosts->defaultServer();
+	if (server == NULL)
+		return;
+	size_t slot = conn->locConfig ? conn->locConfig->metrics_slot : server->getMetricsSlot();
+	_metrics.bytes_out += conn->bytes_sent;
+	_metrics.record(slot, conn->response.status_code, conn->bytes_received, conn->bytes_sent,
+	                conn->timing.total());
+	long phases[PHASE_COUNT];
+	conn->timing.phases(phases);
+	_metrics.recordPhases(phases);
+}
+
+// slots are keyed by listen address, first server name and location path
+void WebServer::assignMetricsSlots() {
+	for (std::vector<ServerConfig>::iterator it = _confs.begin(); it != _confs.end(); ++it) {
+		std::string listen = it->getHost() + ":" + su::to_string(it->getPort());
+		std::string name = it->getServerNames().empty() ? "" : it->getServerNames()[0];
+		it->setMetricsSlot(_metrics.slot(listen, name, ""));
+		std::vector<LocConfig> &locations = it->getLocations();
+		for (std::vector<LocConfig>::iterator loc = locations.begin(); loc != locations.end();
+		     ++loc)
+			loc->metrics_slot = _metrics.slot(listen, name, loc->path);
+	}
+}
+
+Response WebServer::respStubStatus(Connection *conn) {
+	Metrics::Connections conns;
+	conns.active = _connections.size();
+	conns.reading = conns.writing = conns.idle = 0;
+
+	std::set<const Connection *> in_cgi;
+	for (std::map<int, std::pair<CGI *, Connection *> >::const_iterator it = _cgi_pool.begin();
+	     it != _cgi_pool.end(); ++it)
+		in_cgi.insert(it->second.second);
+	for (std::map<int, Connection *>::const_iterator it = _connections.begin();
+	     it != _connections.end(); ++it) {
+		const Connection *c = it->second;
+		if (c->response_ready || in_cgi.count(c) || c->state == Connection::REQUEST_COMPLETE ||
+		    c->state == Connection::CHUNK_COMPLETE)
+			++conns.writing;
+		else if (c->state != Connection::READING_HEADERS || !c->read_buffer.empty())
+			++conns.reading;
+		else
+			++conns.idle;
+	}
+
+	bool basic = conn->locConfig->stub_status == STATUS_BASIC;
+	Response resp(200, basic ? _metrics.basic(conns) : _metrics.prometheus(conns));
+	resp.setContentType(basic ? "text/plain" : "text/plain; version=0.0.4; charset=utf-8");
+	resp.setContentLength(resp.body.size());
+	resp.setHeader("Cache-Control", "no-store");
+	return resp;
+}
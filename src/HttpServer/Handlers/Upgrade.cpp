@@ -0,0 +1,197 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Upgrade.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:02:17 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 14:02:17 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/HttpServer.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/WebServer.hpp"
+
+// Passed from the running binary to the new one
+static const char *ENV_LISTEN_FDS = "WEBSERV_LISTEN_FDS"; // "host:port=fd;host:port=fd"
+static const char *ENV_READY_FD = "WEBSERV_READY_FD";     // write end of the readiness pipe
+
+extern char **environ;
+
+static std::string listenKey(const std::string &host, int port) {
+	return host + ":" + su::to_string<int>(port);
+}
+
+// execve() does not search PATH: a bare command name is looked up before the fork
+static std::string resolveExecutable(const std::string &name) {
+	const char *path = getenv("PATH");
+	if (name.find('/') != std::string::npos || !path)
+		return name;
+	std::istringstream dirs(path);
+	std::string dir;
+	while (std::getline(dirs, dir, ':')) {
+		std::string candidate = (dir.empty() ? "." : dir) + "/" + name;
+		if (access(candidate.c_str(), X_OK) == 0)
+			return candidate;
+	}
+	return name;
+}
+
+void WebServer::startUpgrade() {
+	if (_upgrade_fd != -1 || _draining) {
+		_lggr.warn("SIGUSR2 ignored: an upgrade or a shutdown is already in progress");
+		return;
+	}
+	if (exec_argv.empty()) {
+		_lggr.error("SIGUSR2 ignored: the command line of the binary is unknown");
+		return;
+	}
+
+	std::string fds;
+	const std::map<int, VirtualHosts> &listeners = _config->listeners();
+	for (std::map<int, VirtualHosts>::const_iterator it = listeners.begin();
+	     it != listeners.end(); ++it) {
+		const ServerConfig *sc = it->second.defaultServer();
+		fds += (fds.empty() ? "" : ";") + listenKey(sc->getHost(), sc->getPort()) + "=" +
+		       su::to_string(it->first);
+	}
+
+	int ready[2];
+	if (pipe(ready) == -1) {
+		_lggr.error("Upgrade failed: pipe: " + std::string(strerror(errno)));
+		return;
+	}
+
+	// Everything the child needs is built here: it may only make async-signal-safe
+	// calls, another thread (the log writer) could hold the malloc lock at fork time
+	std::string path = resolveExecutable(exec_argv[0]);
+	std::vector<char *> argv;
+	for (size_t i = 0; i < exec_argv.size(); ++i)
+		argv.push_back(const_cast<char *>(exec_argv[i].c_str()));
+	argv.push_back(NULL);
+
+	std::vector<std::string> env_vars;
+	std::string listen_prefix = std::string(ENV_LISTEN_FDS) + "=";
+	std::string ready_prefix = std::string(ENV_READY_FD) + "=";
+	for (char **e = environ; *e; ++e) {
+		if (std::strncmp(*e, listen_prefix.c_str(), listen_prefix.size()) &&
+		    std::strncmp(*e, ready_prefix.c_str(), ready_prefix.size()))
+			env_vars.push_back(*e);
+	}
+	env_vars.push_back(listen_prefix + fds);
+	env_vars.push_back(ready_prefix + su::to_string(ready[1]));
+	std::vector<char *> envp;
+	for (size_t i = 0; i < env_vars.size(); ++i)
+		envp.push_back(const_cast<char *>(env_vars[i].c_str()));
+	envp.push_back(NULL);
+
+	// new binary: keep stdio, the listening sockets and the readiness pipe only
+	long max_fd = sysconf(_SC_OPEN_MAX);
+	if (max_fd < 0 || max_fd > 65536)
+		max_fd = 65536;
+	std::vector<char> keep(max_fd, 0);
+	keep[ready[1]] = 1;
+	for (std::map<int, VirtualHosts>::const_iterator it = listeners.begin();
+	     it != listeners.end(); ++it) {
+		if (it->first < max_fd)
+			keep[it->first] = 1;
+	}
+
+	pid_t pid = fork();
+	if (pid == -1) {
+		_lggr.error("Upgrade failed: fork: " + std::string(strerror(errno)));
+		close(ready[0]);
+		close(ready[1]);
+		return;
+	}
+
+	if (pid == 0) {
+		for (int fd = 3; fd < max_fd; ++fd) {
+			if (!keep[fd])
+				close(fd);
+		}
+		execve(path.c_str(), &argv[0], &envp[0]);
+		_exit(127);
+	}
+
+	close(ready[1]);
+	_upgrade_fd = ready[0];
+	_upgrade_pid = pid;
+	if (!epollManage(EPOLL_CTL_ADD, _upgrade_fd, EPOLLIN)) {
+		close(_upgrade_fd);
+		_upgrade_fd = -1;
+		return;
+	}
+	LOG_INFO(_lggr, "Upgrade: started " + exec_argv[0] + " (pid " + su::to_string(pid) + ") with " +
+	                su::to_string(listeners.size()) + " listening socket(s)");
+}
+
+void WebServer::handleUpgradeReady() {
+	char byte;
+	ssize_t n = read(_upgrade_fd, &byte, 1);
+	epollManage(EPOLL_CTL_DEL, _upgrade_fd, 0);
+	close(_upgrade_fd);
+	_upgrade_fd = -1;
+
+	if (n == 1) {
+		LOG_INFO(_lggr, "Upgrade: pid " + su::to_string(_upgrade_pid) +
+		                " is accepting connections, draining this process");
+		startDraining();
+		return;
+	}
+	// the new binary closed the pipe without a word: it is exiting, reap it
+	waitpid(_upgrade_pid, NULL, 0);
+	_lggr.error("Upgrade failed: pid " + su::to_string(_upgrade_pid) +
+	            " did not start, this process keeps serving");
+	_upgrade_pid = -1;
+}
+
+void WebServer::inheritListeners() {
+	const char *env = getenv(ENV_LISTEN_FDS);
+	if (!env)
+		return;
+	std::istringstream list(env);
+	std::string item;
+	while (std::getline(list, item, ';')) {
+		size_t eq = item.rfind('=');
+		if (eq == std::string::npos)
+			continue;
+		int fd = std::atoi(item.c_str() + eq + 1);
+		if (fd > 2)
+			_inherited[item.substr(0, eq)] = fd;
+	}
+	unsetenv(ENV_LISTEN_FDS);
+	LOG_INFO(_lggr, "Upgrade: inherited " + su::to_string(_inherited.size()) +
+	                " listening socket(s)");
+}
+
+bool WebServer::takeInheritedListener(ServerConfig &config) {
+	std::map<std::string, int>::iterator it =
+	    _inherited.find(listenKey(config.getHost(), config.getPort()));
+	if (it == _inherited.end())
+		return false;
+	config.setServerFD(it->second);
+	_inherited.erase(it);
+	return true;
+}
+
+void WebServer::notifyUpgradeReady() {
+	// listeners of the previous binary that this configuration does not use
+	for (std::map<std::string, int>::iterator it = _inherited.begin(); it != _inherited.end();
+	     ++it)
+		close(it->second);
+	_inherited.clear();
+
+	const char *env = getenv(ENV_READY_FD);
+	if (!env)
+		return;
+	int fd = std::atoi(env);
+	unsetenv(ENV_READY_FD);
+	if (fd > 2) {
+		if (write(fd, "R", 1) != 1)
+			_lggr.warn("Upgrade: could not notify the previous process");
+		close(fd);
+	}
+}
@@ -0,0 +1,202 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   UploadReq.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 16:31:40 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 16:31:40 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/HttpServer.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/FileUpload.hpp"
+#include "src/HttpServer/Structs/MultipartUpload.hpp"
+#include "src/HttpServer/Structs/Response.hpp"
+#include "src/HttpServer/Structs/WebServer.hpp"
+#include "src/Utils/ServerUtils.hpp"
+
+// boundary parameter of a multipart/form-data Content-Type, quotes removed
+static std::string multipartBoundary(const std::string &ctype) {
+	size_t semi = ctype.find(';');
+	if (su::to_lower(su::trim(ctype.substr(0, semi))) != "multipart/form-data")
+		return "";
+	std::string params = ctype.substr(semi == std::string::npos ? ctype.size() : semi);
+	size_t at = su::to_lower(params).find("boundary=");
+	if (at == std::string::npos)
+		return "";
+	std::string boundary = params.substr(at + 9);
+	if (!boundary.empty() && boundary[0] == '"') {
+		size_t quote = boundary.find('"', 1);
+		return (quote == std::string::npos) ? "" : boundary.substr(1, quote - 1);
+	}
+	return su::trim(boundary.substr(0, boundary.find(';')));
+}
+
+// Resolves the file a PUT or DELETE targets, which must lie in upload_path:
+// its directory has to exist, the file itself may not.
+// \returns 0, or the status to answer with.
+static uint16_t writableTarget(const std::string &path, const LocConfig *loc,
+                               std::string &target) {
+	size_t slash = path.rfind('/');
+	std::string name = path.substr(slash + 1);
+	if (name.empty() || name == "." || name == "..")
+		return 409; // a directory
+	char resolved[PATH_MAX];
+	if (realpath(path.substr(0, slash + 1).c_str(), resolved) == NULL)
+		return 409;
+	std::string dir = std::string(resolved) + "/";
+	if (realpath(loc->getUploadPath().c_str(), resolved) == NULL)
+		return 403;
+	std::string allowed = std::string(resolved) + "/";
+	if (dir.compare(0, allowed.size(), allowed) != 0)
+		return 403;
+	target = dir + name;
+	return 0;
+}
+
+// Writes to upload locations are handled here, unless the target is a CGI
+// script: the script then gets the body as before. A multipart POST streams
+// its files to upload_path, a PUT its body to the target file.
+bool WebServer::startUpload(ClientRequest &req, Connection *conn) {
+	const LocConfig *loc = conn->locConfig;
+	if (!loc->uploadOn() || loc->getUploadPath().empty() ||
+	    loc->acceptExtension(getExtension(conn->full_path)))
+		return true;
+	if (req.method == "PUT")
+		return startPut(req, conn);
+	if (req.method != "POST")
+		return true;
+	std::map<std::string, std::string>::const_iterator ctype = req.headers.find("content-type");
+	if (ctype == req.headers.end() ||
+	    su::to_lower(ctype->second).find("multipart/form-data") == std::string::npos)
+		return true;
+
+	std::string boundary = multipartBoundary(ctype->second);
+	if (boundary.empty() || boundary.size() > 70) {
+		_lggr.logWithPrefix(Logger::WARNING, "HTTP", "File upload request missing boundaries");
+		prepareResponse(conn, Response::badRequest(conn));
+		return false;
+	}
+	std::string dir = loc->getUploadPath();
+	if (mkdir(dir.c_str(), 0755) == -1 && errno != EEXIST) {
+		_lggr.error("Cannot create upload directory " + dir + ": " + strerror(errno));
+		prepareResponse(conn, Response::internalServerError(conn));
+		return false;
+	}
+	conn->upload =
+	    new MultipartUpload(boundary, dir, loc->getUploadMaxFileSize(), loc->uploadFsyncOn());
+	req.file_upload = true;
+	LOG_DEBUG(_lggr, "Streaming multipart upload to " + dir);
+	return true;
+}
+
+bool WebServer::startPut(ClientRequest &req, Connection *conn) {
+	const LocConfig *loc = conn->locConfig;
+	std::string target;
+	uint16_t code = writableTarget(buildFullPath(req.path, loc), loc, target);
+	if (code) {
+		_lggr.error("PUT " + req.path + " refused (" + su::to_string(code) + ")");
+		prepareResponse(conn, Response(code, conn));
+		return false;
+	}
+	FileUpload *put = new FileUpload(target, loc->getUploadMaxFileSize(), loc->uploadFsyncOn());
+	conn->upload = put;
+	if (!put->open(req.content_length > 0 ? req.content_length : 0)) {
+		_lggr.error("PUT " + target + " failed (" + su::to_string(put->status()) + ")");
+		prepareResponse(conn, Response(put->status(), conn));
+		delete put;
+		conn->upload = NULL;
+		return false;
+	}
+	req.file_upload = true;
+	LOG_DEBUG(_lggr, "Streaming PUT body to " + target);
+	return true;
+}
+
+bool WebServer::uploadError(Connection *conn) {
+	uint16_t code = conn->upload->status();
+	_lggr.error("Upload to " + conn->locConfig->getUploadPath() + " failed (" +
+	            su::to_string(code) + ")");
+	prepareResponse(conn, Response(code, conn));
+	conn->should_close = true;
+	conn->state = Connection::REQUEST_COMPLETE;
+	return true;
+}
+
+Response WebServer::respUpload(Connection *conn) {
+	MultipartUpload *upload = static_cast<MultipartUpload *>(conn->upload);
+	conn->upload = NULL;
+	if (!upload->done()) {
+		delete upload;
+		_lggr.error("Multipart body ended before its closing boundary");
+		return Response::badRequest(conn);
+	}
+	std::vector<MultipartUpload::File> files = upload->files();
+	delete upload;
+	if (files.empty()) {
+		_lggr.error("Multipart upload without any file");
+		return Response::badRequest(conn);
+	}
+
+	std::ostringstream html;
+	html << "<!DOCTYPE html>\n"
+	     << "<html>\n"
+	     << "<head>\n"
+	     << "<title>Upload complete</title>\n"
+	     << "</head>\n"
+	     << "<body>\n"
+	     << "<h1>Upload complete</h1>\n"
+	     << "<ul>\n";
+	for (size_t i = 0; i < files.size(); ++i) {
+		html << "<li>" << files[i].name << " (" << files[i].size << " bytes)</li>\n";
+		LOG_INFO(_lggr, "Uploaded " + conn->locConfig->getUploadPath() + files[i].name + " (" +
+		                su::to_string(files[i].size) + " bytes)");
+	}
+	html << "</ul>\n"
+	     << "</body>\n"
+	     << "</html>\n";
+	Response resp(201, html.str());
+	resp.setContentType("text/html");
+	resp.setContentLength(resp.body.size());
+	return resp;
+}
+
+Response WebServer::respPut(ClientRequest &req, Connection *conn) {
+	FileUpload *put = static_cast<FileUpload *>(conn->upload);
+	conn->upload = NULL;
+	bool committed = put->commit();
+	uint16_t code = committed ? (put->replaced() ? 204 : 201) : put->status();
+	LOG_INFO(_lggr, "PUT " + req.path + " (" + su::to_string(put->size()) + " bytes): " +
+	                su::to_string(code));
+	delete put;
+	if (!committed)
+		return Response(code, conn);
+	Response resp(code);
+	if (code == 201) {
+		resp.setHeader("Location", req.path);
+		resp.setContentLength(0);
+	}
+	return resp;
+}
+
+Response WebServer::respDelete(ClientRequest &req, Connection *conn) {
+	std::string target;
+	uint16_t code = writableTarget(buildFullPath(req.path, conn->locConfig), conn->locConfig,
+	                               target);
+	struct stat st;
+	if (code == 0 && lstat(target.c_str(), &st) == -1)
+		code = (errno == ENOENT) ? 404 : 500;
+	else if (code == 0 && S_ISDIR(st.st_mode))
+		code = 409;
+	else if (code == 0 && unlink(target.c_str()) == -1)
+		code = (errno == EACCES || errno == EPERM) ? 403 : 500;
+	if (code) {
+		_lggr.error("DELETE " + req.path + " refused (" + su::to_string(code) + ")");
+		return Response(code, conn);
+	}
+	LOG_INFO(_lggr, "Deleted " + target);
+	return Response(204);
+}
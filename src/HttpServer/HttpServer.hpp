@@ -17,6 +17,7 @@
 #include "src/CGI/CGI.hpp"
 #include "src/ConfigParser/Structs/Struct.hpp"
 #include "src/Logger/Logger.hpp"
+#include "src/Logger/Tracer.hpp"
 #include "src/RequestParser/RequestParser.hpp"
 #include "src/Utils/ArgumentParser.hpp"
 #include "src/Utils/GeneralUtils.hpp"
@@ -0,0 +1,46 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BodySink.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 17:02:33 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 17:02:33 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef BODYSINK_HPP
+#define BODYSINK_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Push-based consumer of a request body, the counterpart of BodyStream:
+/// the body is handed over as it is received instead of being kept in
+/// Connection::body. Handlers finish the sink once the body is complete.
+class BodySink {
+  public:
+	virtual ~BodySink() {}
+
+	/// Consumes the next bytes of the body.
+	/// \returns False once the sink failed, status() tells why.
+	virtual bool feed(const char *data, size_t len) = 0;
+	/// Error status of a failed sink (4xx or 5xx), 0 otherwise.
+	virtual uint16_t status() const = 0;
+};
+
+/// Status of a failed write or file creation: a full disk is 507, the rest 500.
+inline uint16_t writeErrorStatus(int err) {
+	return (err == ENOSPC || err == EDQUOT) ? 507 : 500;
+}
+
+/// Flushes a directory, so the names created in it survive a crash.
+inline void syncDirectory(const std::string &dir) {
+	int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+	if (fd != -1) {
+		fsync(fd);
+		close(fd);
+	}
+}
+
+#endif /* end of include guard: BODYSINK_HPP */
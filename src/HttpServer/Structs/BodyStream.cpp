@@ -0,0 +1,113 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BodyStream.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 12:10:41 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 12:10:41 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "BodyStream.hpp"
+
+// windowBits 15 + 16 asks zlib for a gzip wrapper instead of a zlib one
+#define GZIP_WINDOW_BITS 31
+#define GZIP_MEM_LEVEL 8
+
+/////////////////////////
+// FILESTREAM
+////////
+
+FileStream::FileStream(int fd, off_t offset, off_t length)
+    : _fd(fd),
+      _pos(offset),
+      _end(offset + length) {}
+
+bool FileStream::next(std::string &out) {
+	if (done())
+		return true;
+	char buffer[STREAM_BUFFER_SIZE];
+	size_t want = static_cast<size_t>(_end - _pos);
+	if (want > sizeof(buffer))
+		want = sizeof(buffer);
+	ssize_t bytes = pread(_fd, buffer, want, _pos);
+	if (bytes <= 0) // error, or the file shrank under us
+		return false;
+	out.append(buffer, bytes);
+	_pos += bytes;
+	return true;
+}
+
+bool FileStream::done() const { return _pos >= _end; }
+
+/////////////////////////
+// GZIPSTREAM
+////////
+
+GzipStream::GzipStream(BodyStream *source)
+    : _source(source),
+      _ready(false),
+      _finished(false) {
+	std::memset(&_zs, 0, sizeof(_zs));
+	_ready = deflateInit2(&_zs, GZIP_COMP_LEVEL, Z_DEFLATED, GZIP_WINDOW_BITS, GZIP_MEM_LEVEL,
+	                      Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+GzipStream::~GzipStream() {
+	if (_ready)
+		deflateEnd(&_zs);
+	delete _source;
+}
+
+// Feeds the source through deflate until at least one byte of output exists,
+// so that every call yields a non-empty chunk until the stream is finished.
+bool GzipStream::next(std::string &out) {
+	if (!_ready)
+		return false;
+	size_t before = out.size();
+	unsigned char buffer[STREAM_BUFFER_SIZE];
+
+	while (!_finished && out.size() == before) {
+		std::string in;
+		if (!_source->done() && !_source->next(in))
+			return false;
+		int flush = _source->done() ? Z_FINISH : Z_NO_FLUSH;
+		_zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+		_zs.avail_in = in.size();
+		int ret;
+		do {
+			_zs.next_out = buffer;
+			_zs.avail_out = sizeof(buffer);
+			ret = deflate(&_zs, flush);
+			if (ret == Z_STREAM_ERROR)
+				return false;
+			out.append(reinterpret_cast<char *>(buffer), sizeof(buffer) - _zs.avail_out);
+		} while (_zs.avail_out == 0);
+		if (ret == Z_STREAM_END)
+			_finished = true;
+	}
+	return true;
+}
+
+bool GzipStream::done() const { return _finished; }
+
+bool gzipCompress(const std::string &in, std::string &out) {
+	z_stream zs;
+	std::memset(&zs, 0, sizeof(zs));
+	if (deflateInit2(&zs, GZIP_COMP_LEVEL, Z_DEFLATED, GZIP_WINDOW_BITS, GZIP_MEM_LEVEL,
+	                 Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+	out.resize(deflateBound(&zs, in.size()));
+	zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+	zs.avail_in = in.size();
+	zs.next_out = reinterpret_cast<Bytef *>(&out[0]);
+	zs.avail_out = out.size();
+	int ret = deflate(&zs, Z_FINISH);
+	deflateEnd(&zs);
+	if (ret != Z_STREAM_END)
+		return false;
+	out.resize(zs.total_out);
+	return true;
+}
@@ -0,0 +1,69 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BodyStream.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 12:10:41 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 12:10:41 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef BODYSTREAM_HPP
+#define BODYSTREAM_HPP
+
+#include "includes/Webserv.hpp"
+#include <zlib.h>
+
+/// Pull-based producer for response bodies whose encoded size is not known
+/// when the headers go out. sendResponse() drains it once the send queue is
+/// empty and frames every piece with chunked transfer-encoding.
+class BodyStream {
+  public:
+	virtual ~BodyStream() {}
+
+	/// Appends the next piece of the body to `out`. Returns false on error.
+	virtual bool next(std::string &out) = 0;
+	/// True once the whole body has been produced.
+	virtual bool done() const = 0;
+};
+
+/// Reads [offset, offset + length) of a file descriptor with pread().
+/// The descriptor is not owned: it stays with the Response.
+class FileStream : public BodyStream {
+  public:
+	FileStream(int fd, off_t offset, off_t length);
+
+	bool next(std::string &out);
+	bool done() const;
+
+  private:
+	int _fd;
+	off_t _pos;
+	off_t _end;
+};
+
+/// Gzip-encodes the output of another stream, which it owns.
+class GzipStream : public BodyStream {
+  public:
+	explicit GzipStream(BodyStream *source);
+	~GzipStream();
+
+	bool next(std::string &out);
+	bool done() const;
+
+  private:
+	BodyStream *_source;
+	z_stream _zs;
+	bool _ready;
+	bool _finished;
+
+	GzipStream(const GzipStream &);
+	GzipStream &operator=(const GzipStream &);
+};
+
+/// One-shot gzip encoding of an in-memory body.
+bool gzipCompress(const std::string &in, std::string &out);
+
+#endif /* end of include guard: BODYSTREAM_HPP */
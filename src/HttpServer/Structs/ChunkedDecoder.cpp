@@ -0,0 +1,114 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ChunkedDecoder.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 18:40:12 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 18:40:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/Structs/ChunkedDecoder.hpp"
+
+// chunk-size [ BWS ";" chunk-ext ], between begin and the CRLF at end
+static bool parseChunkSize(const std::string &buf, size_t begin, size_t end, size_t &size) {
+	// only the size line: the rest of the buffer is body
+	const char *semi = static_cast<const char *>(std::memchr(buf.data() + begin, ';', end - begin));
+	size_t stop = semi ? semi - buf.data() : end;
+	while (begin < stop && (buf[begin] == ' ' || buf[begin] == '\t'))
+		++begin;
+	while (stop > begin && (buf[stop - 1] == ' ' || buf[stop - 1] == '\t'))
+		--stop;
+	if (begin == stop || stop - begin > sizeof(size_t) * 2)
+		return false;
+
+	size = 0;
+	for (size_t i = begin; i < stop; ++i) {
+		if (!std::isxdigit(static_cast<unsigned char>(buf[i])))
+			return false;
+		char c = buf[i];
+		size = size * 16 + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+	}
+	return true;
+}
+
+ChunkedDecoder::ChunkedDecoder() : _phase(SIZE), _chunk_size(0), _chunk_read(0) {}
+
+void ChunkedDecoder::reset() {
+	_phase = SIZE;
+	_chunk_size = 0;
+	_chunk_read = 0;
+	_error.clear();
+}
+
+ChunkedDecoder::Result ChunkedDecoder::decode(std::string &buf, std::string &out, size_t limit) {
+	size_t pos = 0;
+	size_t appended = 0;
+	Result result = _phase == DONE ? COMPLETE : MORE;
+
+	while (result == MORE) {
+		if (_phase == SIZE) {
+			size_t eol = buf.find("\r\n", pos);
+			if (eol == std::string::npos) {
+				if (buf.size() - pos > CHUNK_LINE_MAX) {
+					_error = "Chunk size line too long";
+					return BAD_FRAMING;
+				}
+				break;
+			}
+			size_t size;
+			if (!parseChunkSize(buf, pos, eol, size)) {
+				_error = "Invalid chunk size: " + buf.substr(pos, std::min<size_t>(eol - pos, 32));
+				return BAD_FRAMING;
+			}
+			if (size > limit - appended)
+				return TOO_LARGE;
+			pos = eol + 2;
+			_chunk_size = size;
+			_chunk_read = 0;
+			_phase = size ? DATA : TRAILER;
+		}
+
+		else if (_phase == DATA) {
+			size_t take = std::min(_chunk_size - _chunk_read, buf.size() - pos);
+			out.append(buf, pos, take);
+			appended += take;
+			_chunk_read += take;
+			pos += take;
+			if (_chunk_read < _chunk_size)
+				break;
+			_phase = DATA_CRLF;
+		}
+
+		else if (_phase == DATA_CRLF) {
+			if (buf.size() - pos < 2)
+				break;
+			if (buf[pos] != '\r' || buf[pos + 1] != '\n') {
+				_error = "Invalid chunk format: no trailing CRLF";
+				return BAD_FRAMING;
+			}
+			pos += 2;
+			_phase = SIZE;
+		}
+
+		else if (_phase == TRAILER) { // trailer fields, discarded
+			size_t eol = buf.find("\r\n", pos);
+			if (eol == std::string::npos) {
+				if (buf.size() - pos > CHUNK_LINE_MAX) {
+					_error = "Chunked trailer line too long";
+					return BAD_FRAMING;
+				}
+				break;
+			}
+			if (eol == pos) {
+				_phase = DONE;
+				result = COMPLETE;
+			}
+			pos = eol + 2;
+		}
+	}
+	buf.erase(0, pos);
+	return result;
+}
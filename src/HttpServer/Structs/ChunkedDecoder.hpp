@@ -0,0 +1,63 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ChunkedDecoder.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 18:40:12 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 18:40:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CHUNKEDDECODER_HPP
+#define CHUNKEDDECODER_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Incremental decoder of the chunked transfer coding. It knows nothing of
+/// connections: the bytes received so far go in, the payload comes out, and
+/// what follows the trailer section is left for the next request.
+class ChunkedDecoder {
+  public:
+	/// Where the decoder stands in the framing.
+	enum Phase {
+		SIZE,      ///< Reading a chunk size line
+		DATA,      ///< Reading chunk data
+		DATA_CRLF, ///< Reading the CRLF closing the data
+		TRAILER,   ///< Reading the trailer section
+		DONE       ///< Body complete
+	};
+
+	enum Result {
+		MORE,        ///< Everything was consumed, the body goes on
+		COMPLETE,    ///< The body ended, `buf` holds what follows it
+		BAD_FRAMING, ///< Malformed framing, error() tells what
+		TOO_LARGE    ///< A chunk would take the payload past the limit
+	};
+
+	ChunkedDecoder();
+
+	/// Starts over for a new body.
+	void reset();
+
+	/// Walks `buf` once with a cursor, appending chunk payloads to `out`; a
+	/// chunk split over several calls is consumed piece by piece. The consumed
+	/// prefix is dropped once per call, so `buf` never holds more than the
+	/// last read plus an incomplete size or trailer line.
+	/// \param limit Payload bytes that may still be appended.
+	Result decode(std::string &buf, std::string &out, size_t limit);
+
+	Phase phase() const { return _phase; }
+
+	/// What was wrong with the framing, after BAD_FRAMING.
+	const std::string &error() const { return _error; }
+
+  private:
+	Phase _phase;
+	size_t _chunk_size;
+	size_t _chunk_read;
+	std::string _error;
+};
+
+#endif /* end of include guard: CHUNKEDDECODER_HPP */
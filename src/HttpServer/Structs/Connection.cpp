@@ -11,25 +11,41 @@
 /* ************************************************************************** */
 
 #include "Connection.hpp"
+#include "src/HttpServer/Structs/BodyStream.hpp"
 #include "src/HttpServer/Structs/WebServer.hpp"
 #include "src/HttpServer/HttpServer.hpp"
 
 Connection::Connection(int socket_fd)
     : fd(socket_fd),
+      config(NULL),
+      vhosts(NULL),
+      servConfig(NULL),
+      locConfig(NULL),
+      linger_until(0),
       keep_persistent_connection(true),
-      body_bytes_read(0),
       content_length(-1),
+      body_received(0),
+      upload(NULL),
       chunked(false),
-      chunk_size(0),
-      chunk_bytes_read(0),
 	  cgi_response(""),
       response_ready(false),
+      send_offset(0),
+      sending(false),
       request_count(0),
       should_close(0),
+      bytes_sent(0),
+      bytes_received(0),
       state(READING_HEADERS) {
 	updateActivity();
 }
 
+Connection::~Connection() {
+	releaseResponse();
+	delete upload;
+	if (config)
+		config->release();
+}
+
 void Connection::updateActivity() { last_activity = time(NULL); }
 
 bool Connection::isExpired(time_t current_time, int timeout) const {
@@ -41,6 +57,63 @@ void Connection::resetChunkedState() {
 	chunked = false;
 }
 
+void Connection::resetForNewRequest() {
+	content_length = -1;
+	body.clear();
+	body_received = 0;
+	delete upload;
+	upload = NULL;
+	chunks.reset();
+	resetChunkedState();
+}
+
+bool Connection::appendBody(const char *data, size_t len) {
+	body_received += len;
+	if (upload)
+		return upload->feed(data, len);
+	body.append(data, len);
+	return true;
+}
+
+size_t Connection::bodyLeft() const {
+	size_t expected = static_cast<size_t>(content_length);
+	return body_received < expected ? expected - body_received : 0;
+}
+
+void Connection::releaseResponse() {
+	if (response.file_fd != -1)
+		close(response.file_fd);
+	delete response.stream;
+	response.reset();
+	send_queue.clear();
+	send_offset = 0;
+	sending = false;
+}
+
+// Frames one piece of a streamed body for chunked transfer-encoding
+static std::string chunkFrame(const std::string &piece) {
+	std::ostringstream frame;
+	frame << std::hex << piece.size() << "\r\n" << piece << "\r\n";
+	return frame.str();
+}
+
+bool Connection::pullStream() {
+	BodyStream *stream = response.stream;
+	if (stream == NULL)
+		return true;
+	std::string piece;
+	if (!stream->next(piece))
+		return false;
+	if (!piece.empty())
+		send_queue.push_back(BodyPart(chunkFrame(piece), 0, 0));
+	if (stream->done()) {
+		send_queue.push_back(BodyPart("0\r\n\r\n", 0, 0));
+		delete stream;
+		response.stream = NULL;
+	}
+	return true;
+}
+
 std::string Connection::stateToString(Connection::State state) {
 	switch (state) {
 		case Connection::READING_HEADERS:
@@ -57,6 +130,8 @@ std::string Connection::stateToString(Connection::State state) {
 			return "CHUNK_COMPLETE";
 		case Connection::REQUEST_COMPLETE:
 			return "REQUEST_COMPLETE";
+		case Connection::LINGERING:
+			return "LINGERING";
 		default:
 			return "UNKNOWN_STATE";
 	}
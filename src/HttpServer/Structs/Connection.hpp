@@ -13,9 +13,13 @@
 #ifndef CONNECTION_HPP
 #define CONNECTION_HPP
 
+#include "Metrics.hpp"
+#include "BodySink.hpp"
+#include "ChunkedDecoder.hpp"
 #include "Response.hpp"
 #include "includes/Types.hpp"
 #include "includes/Webserv.hpp"
+#include "src/ConfigParser/Structs/ConfigSnapshot.hpp"
 #include "src/ConfigParser/Structs/Struct.hpp"
 
 class WebServer;
@@ -36,32 +40,49 @@ class Connection {
 
 	int fd;
 
-	ServerConfig *servConfig;
-	LocConfig *locConfig;
+	ConfigSnapshot *config;      // configuration the connection was accepted with
+	const VirtualHosts *vhosts;  // servers of the listening socket that accepted it
+
+	// Routing context of the current request, the configuration stays read-only
+	const ServerConfig *servConfig; // selected by the Host header
+	const LocConfig *locConfig;     // matched location
+	std::string full_path;          // resolved filesystem path
 
 	time_t last_activity;
+	long linger_until; // monotonic us, once LINGERING
 	bool keep_persistent_connection;
 
 	std::string read_buffer;
-	size_t body_bytes_read; // for client_max_body_size
 	ssize_t content_length; // ignore if -1
 
-	std::vector<unsigned char> body_data;
+	// Body of the current request, decoded if chunked; swapped into the request
+	// once complete, so it is never copied
+	std::string body;
+	size_t body_received;     // decoded body bytes, also those streamed to an upload
+	BodySink *upload;         // native upload: the body goes to files, not to `body`
 
 	bool chunked;
-	size_t chunk_size;
-	size_t chunk_bytes_read;
-	std::string chunk_data;
-	std::string headers_buffer;
+	ChunkedDecoder chunks;
 
 	ClientRequest parsed_request;
 
 	Response response;
 	std::string cgi_response;
 	bool response_ready;
+
+	// Outgoing data of the response being sent, possibly across several EPOLLOUT
+	std::deque<BodyPart> send_queue;
+	size_t send_offset; // bytes of send_queue.front() already sent
+	bool sending;
 	int request_count;
 	bool should_close;
 
+	// Access log of the current request
+	std::string remote_addr;
+	RequestTiming timing;
+	size_t bytes_sent; // of the response, headers included
+	size_t bytes_received; // of the request, headers included
+
 	/// Represents the current state of request processing.
 	enum State {
 		READING_HEADERS,  ///< Reading request headers
@@ -71,7 +92,8 @@ class Connection {
 		READING_CHUNK_DATA,    ///< Reading chunk data
 		READING_CHUNK_TRAILER, ///< Reading chunk trailer
 		READING_TRAILER,       ///< Reading final trailer
-		CHUNK_COMPLETE         ///< Chunked transfer complete
+		CHUNK_COMPLETE,        ///< Chunked transfer complete
+		LINGERING              ///< Response sent, discarding input before closing
 	};
 
 	State state;
@@ -79,6 +101,7 @@ class Connection {
 	/// Constructs a new Connection object.
 	/// \param socket_fd The file descriptor for the client socket.
 	Connection(int socket_fd);
+	~Connection();
 
 	/// Updates the last activity timestamp to the current time.
 	void updateActivity();
@@ -101,10 +124,31 @@ class Connection {
 	/// \returns The string representation of the state.
 	std::string stateToString(Connection::State state);
 
-	void resetForNewRequest(); // reset locConfig body_bytes_read, ...
+	/// Clears the body and chunk state left by the previous request, so a
+	/// persistent connection starts the next one from a clean slate.
+	void resetForNewRequest();
+
+	/// Adds decoded body bytes to the request, or streams them to the upload.
+	/// \returns False if the upload failed, upload->status() tells why.
+	bool appendBody(const char *data, size_t len);
+
+	/// Bytes of a Content-Length body still to come: what arrives past them
+	/// belongs to the next request.
+	size_t bodyLeft() const;
+
+	/// Drops any queued output and closes the response file, if any.
+	void releaseResponse();
+
+	/// Queues the next chunk of the response stream, if there is one.
+	/// \returns False when the stream failed to produce its next piece.
+	bool pullStream();
+
+	Connection(const Connection &);
+	Connection &operator=(const Connection &);
 
   public:
-	ServerConfig *getServerConfig() const { return servConfig; }
+	const ServerConfig *getServerConfig() const { return servConfig; }
+	const ConfigSnapshot *getConfig() const { return config; }
 };
 
 #endif
@@ -0,0 +1,230 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   DirListing.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:31:52 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 11:31:52 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "DirListing.hpp"
+#include "src/HttpServer/HttpServer.hpp"
+#include "src/Utils/StringUtils.hpp"
+
+static std::string htmlEscape(const std::string &str) {
+	std::string out;
+	out.reserve(str.size());
+	for (size_t i = 0; i < str.size(); ++i) {
+		switch (str[i]) {
+		case '&': out += "&amp;"; break;
+		case '<': out += "&lt;"; break;
+		case '>': out += "&gt;"; break;
+		case '"': out += "&quot;"; break;
+		case '\'': out += "&#39;"; break;
+		default: out += str[i];
+		}
+	}
+	return out;
+}
+
+static std::string jsonEscape(const std::string &str) {
+	std::string out;
+	out.reserve(str.size());
+	for (size_t i = 0; i < str.size(); ++i) {
+		unsigned char c = str[i];
+		if (c == '"' || c == '\\') {
+			out += '\\';
+			out += c;
+		} else if (c < 0x20) {
+			char buf[8];
+			std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+			out += buf;
+		} else
+			out += c;
+	}
+	return out;
+}
+
+/////////////////////////
+// LISTINGCACHE
+////////
+
+ListingCache::ListingCache()
+    : _bytes(0) {}
+
+const std::string *ListingCache::find(const std::string &key, const struct stat &dir_st) const {
+	std::map<std::string, Entry>::const_iterator it = _entries.find(key);
+	if (it == _entries.end() || it->second.ino != dir_st.st_ino ||
+	    it->second.mtime != dir_st.st_mtim.tv_sec || it->second.mtime_ns != dir_st.st_mtim.tv_nsec ||
+	    time(NULL) - it->second.stored >= LISTING_CACHE_TTL)
+		return NULL;
+	return &it->second.body;
+}
+
+void ListingCache::store(const std::string &key, const struct stat &dir_st,
+                         const std::string &body) {
+	if (body.size() > LISTING_CACHE_MAX_BODY)
+		return;
+	std::map<std::string, Entry>::iterator it = _entries.find(key);
+	if (it != _entries.end()) {
+		_bytes -= it->second.body.size();
+		_entries.erase(it);
+	}
+	// no recency tracking: evict in key order until the new body fits
+	while (!_entries.empty() && _bytes + body.size() > LISTING_CACHE_MAX_BYTES) {
+		_bytes -= _entries.begin()->second.body.size();
+		_entries.erase(_entries.begin());
+	}
+	Entry &entry = _entries[key];
+	entry.ino = dir_st.st_ino;
+	entry.mtime = dir_st.st_mtim.tv_sec;
+	entry.mtime_ns = dir_st.st_mtim.tv_nsec;
+	entry.stored = time(NULL);
+	entry.body = body;
+	_bytes += body.size();
+}
+
+/////////////////////////
+// DIRLISTINGSTREAM
+////////
+
+DirListingStream::DirListingStream(DIR *dir, const std::string &title, bool json,
+                                   ListingCache *cache, const std::string &key,
+                                   const struct stat &dir_st)
+    : _dir(dir),
+      _title(title),
+      _json(json),
+      _phase(HEADER),
+      _count(0),
+      _cache(cache),
+      _key(key),
+      _dir_st(dir_st),
+      _capturing(cache != NULL) {}
+
+DirListingStream::~DirListingStream() {
+	if (_dir)
+		closedir(_dir);
+}
+
+bool DirListingStream::next(std::string &out) {
+	size_t start = out.size();
+
+	if (_phase == HEADER) {
+		appendHeader(out);
+		_phase = ENTRIES;
+	}
+	for (size_t i = 0; _phase == ENTRIES && i < LISTING_BATCH; ++i) {
+		errno = 0;
+		struct dirent *entry = readdir(_dir);
+		if (entry == NULL) {
+			if (errno != 0)
+				return false;
+			appendFooter(out);
+			_phase = FINISHED;
+		} else
+			appendEntry(out, entry);
+	}
+
+	if (_capturing) {
+		_capture.append(out, start, std::string::npos);
+		if (_capture.size() > LISTING_CACHE_MAX_BODY) {
+			_capturing = false;
+			std::string().swap(_capture);
+		}
+	}
+	if (_phase == FINISHED && _capturing) {
+		_cache->store(_key, _dir_st, _capture);
+		_capturing = false;
+	}
+	return true;
+}
+
+bool DirListingStream::done() const { return _phase == FINISHED; }
+
+void DirListingStream::appendHeader(std::string &out) const {
+	if (_json) {
+		out += "[";
+		return;
+	}
+	std::string title = htmlEscape(_title);
+	out += "<!DOCTYPE html>\n"
+	       "<html lang=\"en\">\n"
+	       "<head>\n"
+	       "<meta charset=\"UTF-8\">\n"
+	       "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">\n"
+	       "<title>Directory Listing - " + title + "</title>\n"
+	       "<link rel=\"stylesheet\" href=\"/styles.css\">\n"
+	       "</head>\n<body>\n"
+	       "<div class=\"container\">\n"
+	       "<h1 class=\"title\">Directory Listing</h1>\n"
+	       "<p class=\"subtitle\">" + title + "</p>\n"
+	       "<table>\n<tr><th>Name</th><th>Type</th><th>Size</th></tr>\n";
+}
+
+void DirListingStream::appendFooter(std::string &out) const {
+	if (_json) {
+		out += "\n]\n";
+		return;
+	}
+	out += "</table>\n"
+	       "<footer>Generated by WebServer " __WEBSERV_VERSION__ "</footer>\n"
+	       "</div>\n"
+	       "<div class=\"floating-elements\">\n"
+	       "<div class=\"floating-element\"></div>\n"
+	       "<div class=\"floating-element\"></div>\n"
+	       "<div class=\"floating-element\"></div>\n"
+	       "</div>\n"
+	       "</body>\n</html>";
+}
+
+void DirListingStream::appendEntry(std::string &out, const struct dirent *entry) {
+	const char *name = entry->d_name;
+	if (name[0] == '.' && (name[1] == '\0' || (_json && name[1] == '.' && name[2] == '\0')))
+		return;
+
+	// d_type tells directories apart without a stat; sizes still need one
+	struct stat st;
+	bool known = true;
+	unsigned char type = entry->d_type;
+	if (type == DT_UNKNOWN || type == DT_LNK || type == DT_REG) {
+		known = fstatat(dirfd(_dir), name, &st, 0) == 0;
+		if (known)
+			type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+	}
+
+	if (_json) {
+		out += (_count++ ? ",\n" : "\n");
+		out += "{\"name\":\"" + jsonEscape(name) + "\",\"type\":\"";
+		if (!known)
+			out += "unknown\"}";
+		else if (type == DT_DIR)
+			out += "directory\"}";
+		else if (type == DT_REG)
+			out += "file\",\"size\":" + su::to_string(st.st_size) + "}";
+		else
+			out += "other\"}";
+		return;
+	}
+
+	std::string escaped = htmlEscape(name);
+	if (!known) {
+		out += "<tr><td><a href=\"" + escaped + "\">" + escaped +
+		       "</a></td><td>Unknown</td><td>-</td></tr>\n";
+		return;
+	}
+	out += "<tr><td><a href=\"" + escaped;
+	out += (type == DT_DIR) ? "/\" class=\"dir\">" : "\" class=\"file\">";
+	out += escaped + "</a></td><td>";
+	if (type == DT_DIR)
+		out += "<span class=\"dir\">Directory</span>";
+	else if (type == DT_REG)
+		out += "<span class=\"file\">File</span>";
+	else
+		out += "Other";
+	out += "</td><td class=\"size\">";
+	out += (type == DT_REG) ? su::to_string(st.st_size) : "-";
+	out += "</td></tr>\n";
+}
@@ -0,0 +1,82 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   DirListing.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:31:52 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 11:31:52 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef DIRLISTING_HPP
+#define DIRLISTING_HPP
+
+#include "includes/Webserv.hpp"
+#include "src/HttpServer/Structs/BodyStream.hpp"
+
+/// Generated autoindex pages, reused until the directory changes.
+/// An entry is valid while the directory inode and mtime (ns) are unchanged,
+/// for at most LISTING_CACHE_TTL seconds: a file rewritten in place leaves the
+/// directory mtime alone, so its size and date are only refreshed by the TTL.
+class ListingCache {
+  public:
+	ListingCache();
+
+	/// \returns The cached body, or NULL if absent or stale.
+	const std::string *find(const std::string &key, const struct stat &dir_st) const;
+	/// Stores a body generated from a directory in state `dir_st`.
+	void store(const std::string &key, const struct stat &dir_st, const std::string &body);
+
+  private:
+	struct Entry {
+		ino_t ino;
+		time_t mtime;
+		long mtime_ns;
+		time_t stored;
+		std::string body;
+	};
+
+	std::map<std::string, Entry> _entries;
+	size_t _bytes;
+};
+
+/// Streams an autoindex page (HTML or JSON) a batch of entries at a time.
+/// Entry types come from d_type; fstatat() on the directory fd is only used
+/// for file sizes and for entries whose type is unknown or a symlink.
+/// Small listings are stored in the cache once complete.
+class DirListingStream : public BodyStream {
+  public:
+	/// \param dir Open directory, owned (closed) by the stream.
+	DirListingStream(DIR *dir, const std::string &title, bool json, ListingCache *cache,
+	                 const std::string &key, const struct stat &dir_st);
+	~DirListingStream();
+
+	bool next(std::string &out);
+	bool done() const;
+
+  private:
+	enum Phase { HEADER, ENTRIES, FINISHED };
+
+	DIR *_dir;
+	std::string _title;
+	bool _json;
+	Phase _phase;
+	size_t _count;
+
+	ListingCache *_cache;
+	std::string _key;
+	struct stat _dir_st;
+	std::string _capture; // copy of the body while it is small enough to cache
+	bool _capturing;
+
+	void appendHeader(std::string &out) const;
+	void appendFooter(std::string &out) const;
+	void appendEntry(std::string &out, const struct dirent *entry);
+
+	DirListingStream(const DirListingStream &);
+	DirListingStream &operator=(const DirListingStream &);
+};
+
+#endif /* end of include guard: DIRLISTING_HPP */
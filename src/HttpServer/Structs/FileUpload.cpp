@@ -0,0 +1,78 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FileUpload.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 17:02:33 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 17:02:33 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "FileUpload.hpp"
+
+FileUpload::FileUpload(const std::string &path, size_t max_size, bool sync)
+    : _path(path), _max_size(max_size), _sync(sync), _replaced(false), _status(0) {}
+
+uint16_t FileUpload::status() const { return _status; }
+
+bool FileUpload::replaced() const { return _replaced; }
+
+size_t FileUpload::size() const { return _file.size(); }
+
+bool FileUpload::fail(uint16_t code) {
+	_file.discard();
+	_status = code;
+	return false;
+}
+
+bool FileUpload::open(size_t length) {
+	struct stat st;
+	if (stat(_path.c_str(), &st) == 0) {
+		if (S_ISDIR(st.st_mode))
+			return fail(409);
+		_replaced = true;
+	}
+	if (_max_size && length > _max_size)
+		return fail(413);
+
+	// same directory as the target: rename() can't cross file systems
+	if (!_file.create(_path.substr(0, _path.rfind('/') + 1) + ".put-"))
+		return fail(_file.error() == EACCES ? 403 : writeErrorStatus(_file.error()));
+
+	// reserve the blocks up front: less fragmentation, and ENOSPC now rather than
+	// after the body was sent. File systems without fallocate just skip it.
+	if (length > 0 && fallocate(_file.fd(), 0, 0, length) == -1 && errno != EOPNOTSUPP &&
+	    errno != ENOSYS)
+		return fail(writeErrorStatus(errno));
+	return true;
+}
+
+bool FileUpload::feed(const char *data, size_t len) {
+	if (!_file.isOpen())
+		return false;
+	if (_max_size && len > _max_size - _file.size())
+		return fail(413);
+	if (!_file.write(data, len))
+		return fail(writeErrorStatus(_file.error()));
+	return true;
+}
+
+bool FileUpload::commit() {
+	if (!_file.isOpen())
+		return false;
+	// fallocate() sized the file from Content-Length: keep only what was written
+	if (!_file.flush())
+		return fail(writeErrorStatus(_file.error()));
+	if (ftruncate(_file.fd(), _file.size()) == -1)
+		return fail(writeErrorStatus(errno));
+	if (!_file.close(_sync))
+		return fail(writeErrorStatus(_file.error()));
+	if (rename(_file.path().c_str(), _path.c_str()) == -1)
+		return fail(writeErrorStatus(errno));
+	_file.release();
+	if (_sync) // the rename itself lives in the directory
+		syncDirectory(_path.substr(0, _path.rfind('/') + 1));
+	return true;
+}
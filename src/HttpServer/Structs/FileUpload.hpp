@@ -0,0 +1,56 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FileUpload.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 17:02:33 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 17:02:33 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef FILEUPLOAD_HPP
+#define FILEUPLOAD_HPP
+
+#include "BodySink.hpp"
+#include "TempFile.hpp"
+
+/// Writes a PUT body to a temporary file next to its target, then renames it
+/// over the target once complete: readers see the old file or the new one,
+/// never a partial write.
+class FileUpload : public BodySink {
+  public:
+	/// \param path The target file.
+	/// \param max_size Largest accepted body, 0 for no limit.
+	/// \param sync Flush the file and its directory to disk before answering.
+	FileUpload(const std::string &path, size_t max_size, bool sync);
+	/// Creates the temporary file and reserves `length` bytes for it, so a
+	/// full disk is reported before the body is read.
+	/// \returns False on error, status() tells why.
+	bool open(size_t length);
+	bool feed(const char *data, size_t len);
+	/// Renames the temporary file over the target.
+	/// \returns False on error, status() tells why.
+	bool commit();
+	uint16_t status() const;
+
+	/// True if the target existed when the upload started.
+	bool replaced() const;
+	size_t size() const;
+
+  private:
+	std::string _path;
+	TempFile _file;
+	size_t _max_size;
+	bool _sync;
+	bool _replaced;
+	uint16_t _status;
+
+	bool fail(uint16_t code);
+
+	FileUpload(const FileUpload &);
+	FileUpload &operator=(const FileUpload &);
+};
+
+#endif /* end of include guard: FILEUPLOAD_HPP */
@@ -0,0 +1,338 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Metrics.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:20:31 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 14:20:31 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/Structs/Metrics.hpp"
+#include "src/Utils/StringUtils.hpp"
+#include "src/Utils/ServerUtils.hpp"
+
+/////////////////////////
+// LATENCYHISTOGRAM
+////////
+
+LatencyHistogram::LatencyHistogram()
+    : _count(0),
+      _sum_us(0) {
+	std::fill(_counts, _counts + BUCKETS, 0UL);
+}
+
+// values below SUB_BUCKETS have a bucket each, then SUB_BUCKETS per power of two
+int LatencyHistogram::bucketOf(long us) {
+	if (us < SUB_BUCKETS)
+		return us < 0 ? 0 : static_cast<int>(us);
+	if (us >= (1L << MAX_MAGNITUDE))
+		us = (1L << MAX_MAGNITUDE) - 1;
+	int magnitude = static_cast<int>(sizeof(long) * CHAR_BIT) - 1 - __builtin_clzl(us);
+	int shift = magnitude - 3; // SUB_BUCKETS == 1 << 3
+	return SUB_BUCKETS + shift * SUB_BUCKETS + static_cast<int>((us >> shift) - SUB_BUCKETS);
+}
+
+long LatencyHistogram::upperBound(int bucket) {
+	if (bucket < SUB_BUCKETS)
+		return bucket + 1;
+	int shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+	long sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+	return (SUB_BUCKETS + sub + 1) << shift;
+}
+
+void LatencyHistogram::record(long us) {
+	++_counts[bucketOf(us)];
+	++_count;
+	_sum_us += us < 0 ? 0 : us;
+}
+
+unsigned long LatencyHistogram::count() const { return _count; }
+
+unsigned long LatencyHistogram::sumUs() const { return _sum_us; }
+
+unsigned long LatencyHistogram::countBelow(long us) const {
+	unsigned long below = 0;
+	for (int i = 0; i < BUCKETS && upperBound(i) <= us; ++i)
+		below += _counts[i];
+	return below;
+}
+
+long LatencyHistogram::quantile(double q) const {
+	if (_count == 0)
+		return 0;
+	unsigned long rank = static_cast<unsigned long>(q * _count + 0.999999);
+	if (rank == 0)
+		rank = 1;
+	unsigned long seen = 0;
+	for (int i = 0; i < BUCKETS; ++i) {
+		seen += _counts[i];
+		if (seen >= rank)
+			return upperBound(i);
+	}
+	return upperBound(BUCKETS - 1);
+}
+
+/////////////////////////
+// REQUESTTIMING
+////////
+
+RequestTiming::RequestTiming()
+    : accepted(0),
+      start(0) {
+	begin(0);
+}
+
+void RequestTiming::begin(long now) {
+	if (start)
+		accepted = 0; // keep-alive: only the first request waited for its connection
+	start = now;
+	headers = routed = complete = cgi_start = cgi_done = ready = done = 0;
+}
+
+static long span(long from, long to) { return (from && to) ? to - from : -1; }
+
+void RequestTiming::phases(long out[PHASE_COUNT]) const {
+	out[PHASE_ACCEPT] = span(accepted, start);
+	out[PHASE_HEADER] = span(start, headers);
+	out[PHASE_ROUTE] = span(headers, routed);
+	out[PHASE_BODY] = span(routed, complete);
+	out[PHASE_HANDLER] = span(complete, ready);
+	out[PHASE_CGI] = span(cgi_start, cgi_done);
+	out[PHASE_SEND] = span(ready, done);
+}
+
+long RequestTiming::total() const {
+	if (start == 0)
+		return 0;
+	return (done ? done : monotonicUs()) - start;
+}
+
+const char *RequestTiming::phaseName(int phase) {
+	static const char *names[PHASE_COUNT] = {"accept",  "header", "route", "body",
+	                                         "handler", "cgi",    "send"};
+	return names[phase];
+}
+
+/////////////////////////
+// METRICS
+////////
+
+LocationMetrics::LocationMetrics(const std::string &listen, const std::string &name,
+                                 const std::string &loc)
+    : listen(listen),
+      server_name(name),
+      location(loc),
+      requests(0),
+      bytes_in(0),
+      bytes_out(0),
+      latency(NULL) {
+	std::fill(status, status + 5, 0UL);
+}
+
+Metrics::Metrics()
+    : accepted(0),
+      handled(0),
+      requests(0),
+      cgi_spawned(0),
+      cgi_failed(0),
+      bytes_in(0),
+      bytes_out(0),
+      slow_events(0) {}
+
+Metrics::~Metrics() {
+	for (size_t i = 0; i < _slots.size(); ++i)
+		delete _slots[i].latency;
+}
+
+size_t Metrics::slot(const std::string &listen, const std::string &server_name,
+                     const std::string &location) {
+	std::string key = listen + '\n' + server_name + '\n' + location;
+	std::map<std::string, size_t>::iterator it = _index.lower_bound(key);
+	if (it != _index.end() && it->first == key)
+		return it->second;
+	_index.insert(it, std::make_pair(key, _slots.size()));
+	_slots.push_back(LocationMetrics(listen, server_name, location));
+	return _slots.size() - 1;
+}
+
+void Metrics::record(size_t slot, int status, size_t in, size_t out, long us) {
+	++requests;
+	LocationMetrics &m = _slots[slot];
+	++m.requests;
+	if (status >= 100 && status < 600)
+		++m.status[status / 100 - 1];
+	m.bytes_in += in;
+	m.bytes_out += out;
+	if (m.latency == NULL)
+		m.latency = new LatencyHistogram();
+	m.latency->record(us);
+}
+
+void Metrics::recordPhases(const long phases[PHASE_COUNT]) {
+	for (int i = 0; i < PHASE_COUNT; ++i)
+		if (phases[i] >= 0)
+			_phases[i].record(phases[i]);
+}
+
+void Metrics::recordIteration(long us) { _iterations.record(us); }
+
+void Metrics::recordEvent(int kind, long us) { _events[kind].record(us); }
+
+const char *eventKindName(int kind) {
+	static const char *names[EVENT_KINDS] = {"accept", "client", "cgi", "upgrade"};
+	return names[kind];
+}
+
+// label values escape backslash, double quote and newline
+static std::string labelValue(const std::string &value) {
+	std::string out;
+	for (size_t i = 0; i < value.size(); ++i) {
+		if (value[i] == '\\' || value[i] == '"')
+			out += '\\';
+		if (value[i] == '\n')
+			out += "\\n";
+		else
+			out += value[i];
+	}
+	return out;
+}
+
+static void family(std::ostringstream &out, const char *name, const char *type,
+                   const char *help) {
+	out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+}
+
+static std::string seconds(long us) {
+	std::ostringstream out;
+	out << us / 1e6;
+	return out.str();
+}
+
+// histogram buckets exported, in us; counts are exact to the histogram resolution
+static const long bounds[] = {500,    1000,    2500,    5000,    10000,   25000,  50000,
+                              100000, 250000,  500000,  1000000, 2500000, 5000000, 10000000};
+static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+// _bucket, _sum and _count lines of one labelled histogram
+static void histogram(std::ostringstream &out, const std::string &name, const std::string &labels,
+                      const LatencyHistogram &h) {
+	std::string le = labels.empty() ? "{le=\"" : "{" + labels + ",le=\"";
+	std::string tags = labels.empty() ? "" : "{" + labels + "}";
+	for (size_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); ++b)
+		out << name << "_bucket" << le << seconds(bounds[b]) << "\"} " << h.countBelow(bounds[b])
+		    << '\n';
+	out << name << "_bucket" << le << "+Inf\"} " << h.count() << '\n'
+	    << name << "_sum" << tags << ' ' << seconds(h.sumUs()) << '\n'
+	    << name << "_count" << tags << ' ' << h.count() << '\n';
+}
+
+static void quantileLines(std::ostringstream &out, const std::string &name,
+                          const std::string &labels, const LatencyHistogram &h) {
+	std::string prefix = labels.empty() ? "{" : "{" + labels + ",";
+	for (size_t q = 0; h.count() && q < sizeof(quantiles) / sizeof(quantiles[0]); ++q)
+		out << name << prefix << "quantile=\"" << quantiles[q] << "\"} "
+		    << seconds(h.quantile(quantiles[q])) << '\n';
+}
+
+std::string Metrics::prometheus(const Connections &conns) const {
+	std::ostringstream out;
+
+	family(out, "webserv_connections", "gauge", "Open client connections by state.");
+	out << "webserv_connections{state=\"active\"} " << conns.active << '\n'
+	    << "webserv_connections{state=\"reading\"} " << conns.reading << '\n'
+	    << "webserv_connections{state=\"writing\"} " << conns.writing << '\n'
+	    << "webserv_connections{state=\"idle\"} " << conns.idle << '\n';
+	family(out, "webserv_connections_accepted_total", "counter", "Accepted connections.");
+	out << "webserv_connections_accepted_total " << accepted << '\n';
+	family(out, "webserv_connections_handled_total", "counter",
+	       "Connections registered with the event loop.");
+	out << "webserv_connections_handled_total " << handled << '\n';
+	family(out, "webserv_requests_total", "counter", "Requests answered.");
+	out << "webserv_requests_total " << requests << '\n';
+	family(out, "webserv_received_bytes_total", "counter", "Bytes read from clients.");
+	out << "webserv_received_bytes_total " << bytes_in << '\n';
+	family(out, "webserv_sent_bytes_total", "counter", "Bytes sent to clients.");
+	out << "webserv_sent_bytes_total " << bytes_out << '\n';
+	family(out, "webserv_cgi_spawned_total", "counter", "CGI scripts started.");
+	out << "webserv_cgi_spawned_total " << cgi_spawned << '\n';
+	family(out, "webserv_cgi_failed_total", "counter",
+	       "CGI scripts that could not start or answered badly.");
+	out << "webserv_cgi_failed_total " << cgi_failed << '\n';
+
+	std::vector<std::string> labels(_slots.size());
+	for (size_t i = 0; i < _slots.size(); ++i)
+		labels[i] = "listen=\"" + labelValue(_slots[i].listen) + "\",server_name=\"" +
+		            labelValue(_slots[i].server_name) + "\",location=\"" +
+		            labelValue(_slots[i].location) + "\"";
+
+	// locations without requests are left out: generated configs have thousands
+	family(out, "webserv_http_requests_total", "counter", "Requests by location and status class.");
+	for (size_t i = 0; i < _slots.size(); ++i)
+		for (int c = 0; c < 5 && _slots[i].requests; ++c)
+			out << "webserv_http_requests_total{" << labels[i] << ",status=\"" << c + 1 << "xx\"} "
+			    << _slots[i].status[c] << '\n';
+	family(out, "webserv_http_received_bytes_total", "counter", "Request bytes by location.");
+	for (size_t i = 0; i < _slots.size(); ++i)
+		if (_slots[i].requests)
+			out << "webserv_http_received_bytes_total{" << labels[i] << "} " << _slots[i].bytes_in
+			    << '\n';
+	family(out, "webserv_http_sent_bytes_total", "counter", "Response bytes by location.");
+	for (size_t i = 0; i < _slots.size(); ++i)
+		if (_slots[i].requests)
+			out << "webserv_http_sent_bytes_total{" << labels[i] << "} " << _slots[i].bytes_out
+			    << '\n';
+
+	family(out, "webserv_http_request_duration_seconds", "histogram",
+	       "Time from the first byte of a request to the last byte of its response.");
+	for (size_t i = 0; i < _slots.size(); ++i)
+		if (_slots[i].latency)
+			histogram(out, "webserv_http_request_duration_seconds", labels[i], *_slots[i].latency);
+	family(out, "webserv_request_phase_seconds", "histogram",
+	       "Time spent in each phase of a request, over all servers.");
+	for (int p = 0; p < PHASE_COUNT; ++p)
+		if (_phases[p].count())
+			histogram(out, "webserv_request_phase_seconds",
+			          std::string("phase=\"") + RequestTiming::phaseName(p) + "\"", _phases[p]);
+	family(out, "webserv_event_loop_iteration_seconds", "histogram",
+	       "Time the event loop spent between two epoll_wait calls: how late a ready event can "
+	       "be served.");
+	histogram(out, "webserv_event_loop_iteration_seconds", "", _iterations);
+	family(out, "webserv_event_handler_seconds", "histogram",
+	       "Time spent handling one epoll event, by kind of file descriptor.");
+	for (int k = 0; k < EVENT_KINDS; ++k)
+		if (_events[k].count())
+			histogram(out, "webserv_event_handler_seconds",
+			          std::string("kind=\"") + eventKindName(k) + "\"", _events[k]);
+	family(out, "webserv_event_loop_slow_events_total", "counter",
+	       "Events whose handler blocked the loop longer than --slow-event.");
+	out << "webserv_event_loop_slow_events_total " << slow_events << '\n';
+
+	family(out, "webserv_request_phase_quantile_seconds", "gauge",
+	       "Phase duration quantiles since start, within 12.5%.");
+	for (int p = 0; p < PHASE_COUNT; ++p)
+		quantileLines(out, "webserv_request_phase_quantile_seconds",
+		              std::string("phase=\"") + RequestTiming::phaseName(p) + "\"", _phases[p]);
+	family(out, "webserv_event_loop_iteration_quantile_seconds", "gauge",
+	       "Event loop iteration quantiles since start, within 12.5%.");
+	quantileLines(out, "webserv_event_loop_iteration_quantile_seconds", "", _iterations);
+	family(out, "webserv_http_request_duration_quantile_seconds", "gauge",
+	       "Latency quantiles since start, within 12.5%.");
+	for (size_t i = 0; i < _slots.size(); ++i)
+		if (_slots[i].latency)
+			quantileLines(out, "webserv_http_request_duration_quantile_seconds", labels[i],
+			              *_slots[i].latency);
+	return out.str();
+}
+
+std::string Metrics::basic(const Connections &conns) const {
+	std::ostringstream out;
+	out << "Active connections: " << conns.active << " \n"
+	    << "server accepts handled requests\n"
+	    << ' ' << accepted << ' ' << handled << ' ' << requests << " \n"
+	    << "Reading: " << conns.reading << " Writing: " << conns.writing
+	    << " Waiting: " << conns.idle << " \n";
+	return out.str();
+}
@@ -0,0 +1,158 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Metrics.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:20:31 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 14:20:31 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Request latencies in HDR-style log-linear buckets: every power of two of
+/// microseconds is split into SUB_BUCKETS linear buckets, so a value is known
+/// within 1/SUB_BUCKETS of itself from 1 us up to 2^MAX_MAGNITUDE us (~25 days).
+/// Recording is an index computation and an increment.
+class LatencyHistogram {
+  public:
+	static const int SUB_BUCKETS = 8;
+	static const int MAX_MAGNITUDE = 41;
+	static const int BUCKETS = SUB_BUCKETS * (MAX_MAGNITUDE - 2);
+
+	LatencyHistogram();
+
+	void record(long us);
+	unsigned long count() const;
+	unsigned long sumUs() const;
+	/// \returns The number of values below `us`, at bucket resolution.
+	unsigned long countBelow(long us) const;
+	/// \returns The upper bound of the bucket holding quantile q (0 < q <= 1).
+	long quantile(double q) const;
+
+  private:
+	unsigned long _counts[BUCKETS];
+	unsigned long _count;
+	unsigned long _sum_us;
+
+	static int bucketOf(long us);
+	static long upperBound(int bucket); // exclusive
+};
+
+/// Phases of a request, as measured by RequestTiming::phases().
+enum Phase {
+	PHASE_ACCEPT,  ///< accept() to first byte, first request of a connection only
+	PHASE_HEADER,  ///< first byte to parsed headers
+	PHASE_ROUTE,   ///< virtual host, location, path and request checks
+	PHASE_BODY,    ///< body received
+	PHASE_HANDLER, ///< request complete to response prepared, CGI included
+	PHASE_CGI,     ///< CGI started to its output read
+	PHASE_SEND,    ///< response prepared to last byte sent
+	PHASE_COUNT
+};
+
+/// Monotonic timestamps (us) of the current request of a connection, 0 for
+/// a point the request did not reach.
+struct RequestTiming {
+	long accepted;
+	long start;
+	long headers;
+	long routed;
+	long complete;
+	long cgi_start;
+	long cgi_done;
+	long ready;
+	long done;
+
+	RequestTiming();
+	/// Forgets the previous request, which started at `now`.
+	void begin(long now);
+	/// Durations in us, -1 for the phases the request skipped.
+	void phases(long out[PHASE_COUNT]) const;
+	/// \returns First byte to last byte (or to now, if not done yet).
+	long total() const;
+
+	static const char *phaseName(int phase);
+};
+
+/// File descriptors the event loop dispatches events for.
+enum EventKind { EVENT_ACCEPT, EVENT_CLIENT, EVENT_CGI, EVENT_UPGRADE, EVENT_KINDS };
+
+const char *eventKindName(int kind);
+
+/// Counters of one location (or of a server's requests that matched none).
+struct LocationMetrics {
+	std::string listen;
+	std::string server_name;
+	std::string location;
+	unsigned long requests;
+	unsigned long status[5]; // 1xx to 5xx
+	unsigned long bytes_in;
+	unsigned long bytes_out;
+	LatencyHistogram *latency; // allocated by the first request
+
+	LocationMetrics(const std::string &listen, const std::string &name, const std::string &loc);
+};
+
+/// Process-wide counters, exported by stub_status locations.
+///
+/// The event loop is the only writer and the scrape runs on it too, so the
+/// hot path is plain increments: no atomics, no locks. Locations get a slot
+/// when a configuration is compiled; a slot is keyed by listen address,
+/// server name and location path, so its counters survive a reload.
+class Metrics {
+  public:
+	/// Connections by state, counted when scraped.
+	struct Connections {
+		size_t active;
+		size_t reading;
+		size_t writing;
+		size_t idle;
+	};
+
+	unsigned long accepted;
+	unsigned long handled;
+	unsigned long requests;
+	unsigned long cgi_spawned;
+	unsigned long cgi_failed;
+	unsigned long bytes_in;
+	unsigned long bytes_out;
+	unsigned long slow_events; // handlers over the --slow-event threshold
+
+	Metrics();
+	~Metrics();
+
+	/// \returns The slot of a location, created on first use.
+	size_t slot(const std::string &listen, const std::string &server_name,
+	            const std::string &location);
+	/// Counts a finished request in `slot`.
+	void record(size_t slot, int status, size_t in, size_t out, long us);
+	/// Adds the phases of a finished request to the phase histograms.
+	void recordPhases(const long phases[PHASE_COUNT]);
+	/// Counts the busy time of one event loop iteration.
+	void recordIteration(long us);
+	/// Counts the handling time of one event of `kind` (EventKind).
+	void recordEvent(int kind, long us);
+
+	/// Prometheus text exposition format (version 0.0.4).
+	std::string prometheus(const Connections &conns) const;
+	/// nginx stub_status format.
+	std::string basic(const Connections &conns) const;
+
+  private:
+	std::vector<LocationMetrics> _slots;
+	LatencyHistogram _phases[PHASE_COUNT];
+	LatencyHistogram _iterations;
+	LatencyHistogram _events[EVENT_KINDS];
+	std::map<std::string, size_t> _index;
+
+	Metrics(const Metrics &);
+	Metrics &operator=(const Metrics &);
+};
+
+#endif
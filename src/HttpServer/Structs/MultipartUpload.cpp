@@ -0,0 +1,226 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MultipartUpload.cpp                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 16:05:12 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 16:05:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "MultipartUpload.hpp"
+#include "src/Utils/StringUtils.hpp"
+
+// Keeps [A-Za-z0-9._-] of the last path component, without leading dots
+static std::string sanitizeFilename(const std::string &raw) {
+	std::string name = raw.substr(raw.find_last_of("/\\") + 1);
+	for (size_t i = 0; i < name.size(); ++i) {
+		unsigned char c = name[i];
+		if (!std::isalnum(c) && c != '.' && c != '-' && c != '_')
+			name[i] = '_';
+	}
+	if (name.size() > UPLOAD_NAME_MAX) // the end holds the extension
+		name.erase(0, name.size() - UPLOAD_NAME_MAX);
+	size_t start = name.find_first_not_of('.');
+	if (start == std::string::npos)
+		return "upload";
+	return name.substr(start);
+}
+
+// filename parameter of a Content-Disposition value, empty if there is none
+static std::string dispositionFilename(const std::string &value) {
+	size_t i = value.find(';');
+	while (i < value.size()) {
+		size_t eq = value.find('=', i);
+		if (eq == std::string::npos)
+			break;
+		std::string key = su::to_lower(su::trim(value.substr(i + 1, eq - i - 1)));
+		i = eq + 1;
+		while (i < value.size() && (value[i] == ' ' || value[i] == '\t'))
+			++i;
+		std::string param;
+		if (i < value.size() && value[i] == '"') {
+			for (++i; i < value.size() && value[i] != '"'; ++i) {
+				if (value[i] == '\\' && i + 1 < value.size() && value[i + 1] == '"')
+					++i;
+				param += value[i];
+			}
+			i = value.find(';', i);
+		} else {
+			size_t end = value.find(';', i);
+			param = su::trim(value.substr(i, end == std::string::npos ? end : end - i));
+			i = end;
+		}
+		if (key == "filename")
+			return param;
+	}
+	return "";
+}
+
+MultipartUpload::MultipartUpload(const std::string &boundary, const std::string &dir,
+                                 size_t max_file_size, bool sync)
+    : _delimiter("\r\n--" + boundary),
+      _dir(dir),
+      _max_file_size(max_file_size),
+      _sync(sync),
+      _buf("\r\n"), // the first delimiter has no CRLF of its own
+      _state(PREAMBLE),
+      _status(0) {}
+
+bool MultipartUpload::done() const { return _state == EPILOGUE; }
+
+uint16_t MultipartUpload::status() const { return _status; }
+
+const std::vector<MultipartUpload::File> &MultipartUpload::files() const { return _files; }
+
+// Data is written up to the next delimiter; the last delimiter size - 1 bytes
+// stay buffered while they could still be its beginning.
+bool MultipartUpload::feed(const char *data, size_t len) {
+	if (_state == FAILED)
+		return false;
+	if (_state == EPILOGUE)
+		return true;
+	_buf.append(data, len);
+
+	size_t pos = 0;
+	while (_state != EPILOGUE) {
+		if (_state == PREAMBLE || _state == PART_DATA) {
+			size_t found = _buf.find(_delimiter, pos);
+			if (found == std::string::npos) {
+				size_t keep = _delimiter.size() - 1;
+				if (_buf.size() - pos > keep) {
+					size_t n = _buf.size() - pos - keep;
+					if (_state == PART_DATA && !writeData(_buf.data() + pos, n))
+						return false;
+					pos += n;
+				}
+				break;
+			}
+			if (_state == PART_DATA &&
+			    (!writeData(_buf.data() + pos, found - pos) || !finishPart()))
+				return false;
+			pos = found + _delimiter.size();
+			_state = BOUNDARY;
+		}
+
+		else if (_state == BOUNDARY) { // "--" closes the body, CRLF opens a part
+			size_t i = pos;
+			while (i < _buf.size() && (_buf[i] == ' ' || _buf[i] == '\t'))
+				++i;
+			if (_buf.size() - i < 2) {
+				if (i - pos > UPLOAD_HEADER_MAX)
+					return fail(400);
+				break;
+			}
+			if (_buf.compare(i, 2, "--") == 0) {
+				pos = _buf.size(); // the epilogue is ignored
+				_state = EPILOGUE;
+			} else if (_buf.compare(i, 2, "\r\n") == 0) {
+				pos = i + 2;
+				_state = PART_HEADERS;
+			} else
+				return fail(400);
+		}
+
+		else if (_state == PART_HEADERS) {
+			size_t end = pos;
+			if (_buf.compare(pos, 2, "\r\n") != 0) {
+				end = _buf.find("\r\n\r\n", pos);
+				if (end == std::string::npos) {
+					if (_buf.size() - pos > UPLOAD_HEADER_MAX)
+						return fail(400);
+					break;
+				}
+				end += 2;
+			}
+			if (!startPart(_buf.substr(pos, end - pos)))
+				return false;
+			pos = end + 2;
+			_state = PART_DATA;
+		}
+	}
+	_buf.erase(0, pos);
+	return true;
+}
+
+bool MultipartUpload::fail(uint16_t code) {
+	_file.discard();
+	_buf.clear();
+	_state = FAILED;
+	_status = code;
+	return false;
+}
+
+// Opens the temporary file of a part with a filename, other parts are skipped
+bool MultipartUpload::startPart(const std::string &headers) {
+	std::string filename;
+	size_t begin = 0;
+	while (begin < headers.size()) {
+		size_t end = headers.find("\r\n", begin);
+		if (end == std::string::npos)
+			end = headers.size();
+		size_t colon = headers.find(':', begin);
+		if (colon < end &&
+		    su::to_lower(su::trim(headers.substr(begin, colon - begin))) == "content-disposition")
+			filename = dispositionFilename(headers.substr(colon + 1, end - colon - 1));
+		begin = end + 2;
+	}
+	if (filename.empty())
+		return true;
+
+	_filename = sanitizeFilename(filename);
+	if (!_file.create(_dir + ".upload-"))
+		return fail(writeErrorStatus(_file.error()));
+	return true;
+}
+
+bool MultipartUpload::writeData(const char *data, size_t len) {
+	if (!_file.isOpen() || len == 0)
+		return true;
+	if (_max_file_size && len > _max_file_size - _file.size())
+		return fail(413);
+	if (!_file.write(data, len))
+		return fail(writeErrorStatus(_file.error()));
+	return true;
+}
+
+// Publishes the part under its name, or name(1).ext, name(2).ext... when taken:
+// link() never replaces an existing file, so concurrent uploads can't collide
+bool MultipartUpload::finishPart() {
+	if (!_file.isOpen())
+		return true;
+	if (!_file.close(_sync))
+		return fail(writeErrorStatus(_file.error()));
+	const std::string &tmp_path = _file.path();
+
+	size_t dot = _filename.rfind('.');
+	if (dot == std::string::npos)
+		dot = _filename.size();
+	std::string name = _filename;
+	for (int n = 1; n <= 1000; ++n) {
+		if (link(tmp_path.c_str(), (_dir + name).c_str()) == 0)
+			break;
+		if (errno != EEXIST) {
+			// no hard links on this file system: rename, which can't detect a race
+			if (access((_dir + name).c_str(), F_OK) == 0)
+				errno = EEXIST;
+			else if (rename(tmp_path.c_str(), (_dir + name).c_str()) == 0)
+				break;
+			if (errno != EEXIST)
+				return fail(writeErrorStatus(errno));
+		}
+		name = _filename.substr(0, dot) + "(" + su::to_string(n) + ")" + _filename.substr(dot);
+		if (n == 1000)
+			return fail(500);
+	}
+	File file;
+	file.name = name;
+	file.size = _file.size();
+	_file.discard(); // the temporary name, a no-op after a rename
+	if (_sync)
+		syncDirectory(_dir);
+	_files.push_back(file);
+	return true;
+}
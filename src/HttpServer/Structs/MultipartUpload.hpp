@@ -0,0 +1,71 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MultipartUpload.hpp                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 16:05:12 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 16:05:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MULTIPARTUPLOAD_HPP
+#define MULTIPARTUPLOAD_HPP
+
+#include "BodySink.hpp"
+#include "TempFile.hpp"
+
+/// Streaming multipart/form-data parser writing file parts into a directory.
+/// The body is fed as it arrives: each file part goes to a temporary file in
+/// the upload directory and is published under its (sanitized) filename once
+/// its closing boundary is seen, so memory stays bounded by one read plus a
+/// part header. Fields without a filename are discarded.
+class MultipartUpload : public BodySink {
+  public:
+	struct File {
+		std::string name; // as saved in the directory
+		size_t size;
+	};
+
+	/// \param boundary The boundary parameter of the Content-Type.
+	/// \param dir The upload directory, ending with '/'.
+	/// \param max_file_size Largest accepted file part, 0 for no limit.
+	/// \param sync Flush each file to disk before publishing it.
+	MultipartUpload(const std::string &boundary, const std::string &dir, size_t max_file_size,
+	                bool sync);
+	/// Parses the next bytes of the body.
+	/// \returns False once the upload failed, status() tells why.
+	bool feed(const char *data, size_t len);
+	/// True once the closing boundary was parsed.
+	bool done() const;
+	/// 400 malformed body, 413 file part too large, 500/507 write errors.
+	uint16_t status() const;
+	/// Files saved so far, in body order.
+	const std::vector<File> &files() const;
+
+  private:
+	enum State { PREAMBLE, BOUNDARY, PART_HEADERS, PART_DATA, EPILOGUE, FAILED };
+
+	std::string _delimiter; // CRLF "--" boundary
+	std::string _dir;
+	size_t _max_file_size;
+	bool _sync;
+	std::string _buf; // unparsed bytes: a part header or a possible partial delimiter
+	State _state;
+	uint16_t _status;
+
+	TempFile _file; // file part being written, not open for discarded fields
+	std::string _filename;
+	std::vector<File> _files;
+
+	bool fail(uint16_t code);
+	bool startPart(const std::string &headers);
+	bool writeData(const char *data, size_t len);
+	bool finishPart();
+
+	MultipartUpload(const MultipartUpload &);
+	MultipartUpload &operator=(const MultipartUpload &);
+};
+
+#endif /* end of include guard: MULTIPARTUPLOAD_HPP */
@@ -19,24 +19,32 @@
 Response::Response()
     : version("HTTP/1.1"),
       status_code(0),
-      reason_phrase("Not Ready") {}
+      reason_phrase("Not Ready"),
+      file_fd(-1),
+      stream(NULL) {}
 
 Response::Response(uint16_t code)
     : version("HTTP/1.1"),
-      status_code(code) {
+      status_code(code),
+      file_fd(-1),
+      stream(NULL) {
 	initFromStatusCode(code);
 }
 
 Response::Response(uint16_t code, const std::string &response_body)
     : version("HTTP/1.1"),
       status_code(code),
-      body(response_body) {
+      body(response_body),
+      file_fd(-1),
+      stream(NULL) {
 	initFromStatusCode(code);
 }
 
 Response::Response(uint16_t code, Connection *conn)
     : version("HTTP/1.1"),
-      status_code(code) {
+      status_code(code),
+      file_fd(-1),
+      stream(NULL) {
 	initFromCustomErrorPage(code, conn);
 }
 
@@ -79,6 +87,9 @@ void Response::reset() {
 	reason_phrase = "Not ready";
 	headers.clear();
 	body.clear();
+	file_fd = -1;
+	file_parts.clear();
+	stream = NULL;
 }
 
 Response Response::continue_() { return Response(100); }
@@ -149,6 +160,8 @@ std::string Response::getReasonPhrase(uint16_t code) const {
 		return "Created";
 	case 204:
 		return "No Content";
+	case 206:
+		return "Partial Content";
 	case 301:
 		return "Moved Permanently";
 	case 302:
@@ -173,6 +186,8 @@ std::string Response::getReasonPhrase(uint16_t code) const {
 		return "Content Too Large";
 	case 414:
 		return "URI Too Long";
+	case 416:
+		return "Range Not Satisfiable";
 	case 417:
 		return "Expectation Failed";
 	case 500:
@@ -187,6 +202,8 @@ std::string Response::getReasonPhrase(uint16_t code) const {
 		return "CGI Time-out";
 	case 505:
 		return "HTTP version not supported";
+	case 507:
+		return "Insufficient Storage";
 	default:
 		return "Unknown Status";
 	}
@@ -212,7 +229,7 @@ void Response::initFromCustomErrorPage(uint16_t code, Connection *conn) {
 	errorPage << errorFile.rdbuf();
 	body = errorPage.str();
 	setContentLength(body.length());
-	setContentType(detectContentType(fullPath));
+	setContentType(detectContentType(conn->getConfig()->mimeTypes(), fullPath));
 	errorFile.close();
 }
 
@@ -18,6 +18,20 @@
 #include "src/Utils/StringUtils.hpp"
 
 class Connection;
+class BodyStream;
+
+/// A slice of a file-backed response body: literal bytes (e.g. a multipart
+/// delimiter) followed by `length` bytes of the response file from `offset`.
+struct BodyPart {
+	std::string data;
+	off_t offset;
+	size_t length;
+
+	BodyPart(const std::string &d, off_t off, size_t len)
+	    : data(d),
+	      offset(off),
+	      length(len) {}
+};
 
 class Response {
   public:
@@ -27,6 +41,14 @@ class Response {
 	std::map<std::string, std::string> headers; // e.g. Content-Type: text/html
 	std::string body;                           // e.g. <h1>Hello world!</h1>
 
+	// File-backed body, sent with sendfile() after the headers.
+	// Ownership of file_fd moves to the Connection in prepareResponse().
+	int file_fd;
+	std::vector<BodyPart> file_parts;
+	// Body produced on the fly (e.g. gzip), sent chunked after file_parts.
+	// Ownership moves to the Connection like file_fd.
+	BodyStream *stream;
+
 	Response();
 	explicit Response(uint16_t code);
 	explicit Response(uint16_t code, const std::string &response_body);
@@ -47,6 +69,10 @@ class Response {
 		headers["Content-Length"] = su::to_string(length);
 	}
 
+	inline bool hasFileBody() const { return file_fd != -1; }
+
+	inline bool hasStream() const { return stream != NULL; }
+
 	std::string toString() const;
 	std::string toStringHeadersOnly() const;
 	std::string toShortString() const;
@@ -0,0 +1,99 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TempFile.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 19:10:44 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 19:10:44 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "TempFile.hpp"
+
+TempFile::TempFile() : _fd(-1), _size(0), _error(0) {}
+
+TempFile::~TempFile() { discard(); }
+
+bool TempFile::create(const std::string &prefix) {
+	discard();
+	std::string tmpl = prefix + "XXXXXX";
+	std::vector<char> path(tmpl.begin(), tmpl.end());
+	path.push_back('\0');
+	_fd = mkstemp(&path[0]);
+	if (_fd == -1)
+		return fail();
+	_path = &path[0];
+	fcntl(_fd, F_SETFD, FD_CLOEXEC); // not for CGI children
+	fchmod(_fd, 0644);
+	_buf.reserve(UPLOAD_BUFFER_SIZE);
+	_size = 0;
+	return true;
+}
+
+bool TempFile::write(const char *data, size_t len) {
+	if (_fd == -1)
+		return false;
+	if (_buf.size() + len > UPLOAD_BUFFER_SIZE && !flush())
+		return false;
+	_size += len;
+	if (len >= UPLOAD_BUFFER_SIZE) // as large as the buffer: no point copying it
+		return writeAll(data, len);
+	_buf.append(data, len);
+	return true;
+}
+
+bool TempFile::flush() {
+	if (_fd == -1)
+		return false;
+	if (_buf.empty())
+		return true;
+	bool ok = writeAll(_buf.data(), _buf.size());
+	_buf.clear();
+	return ok;
+}
+
+bool TempFile::close(bool sync) {
+	if (_fd == -1)
+		return false;
+	bool ok = flush();
+	if (ok && sync && fsync(_fd) == -1)
+		ok = fail();
+	if (::close(_fd) == -1 && ok)
+		ok = fail();
+	_fd = -1;
+	return ok;
+}
+
+void TempFile::discard() {
+	if (_fd != -1)
+		::close(_fd);
+	if (!_path.empty())
+		unlink(_path.c_str());
+	release();
+}
+
+void TempFile::release() {
+	_fd = -1;
+	_path.clear();
+	_buf.clear();
+}
+
+bool TempFile::writeAll(const char *data, size_t len) {
+	while (len > 0) {
+		ssize_t n = ::write(_fd, data, len);
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return fail();
+		data += n;
+		len -= n;
+	}
+	return true;
+}
+
+bool TempFile::fail() {
+	_error = errno ? errno : EIO;
+	return false;
+}
@@ -0,0 +1,66 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TempFile.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 19:10:44 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 19:10:44 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef TEMPFILE_HPP
+#define TEMPFILE_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Temporary file an upload is written to before its owner publishes it under
+/// the final name. Writes go through a buffer of UPLOAD_BUFFER_SIZE bytes, so
+/// a body fed in small pieces still costs one write() per buffer. The file is
+/// removed on destruction unless it was released.
+class TempFile {
+  public:
+	TempFile();
+	~TempFile();
+
+	/// Creates `prefix` followed by a unique suffix, mode 0644, close-on-exec.
+	/// \returns False on error, error() holds errno.
+	bool create(const std::string &prefix);
+	/// Appends bytes, writing the buffer out whenever it is full.
+	/// \returns False on error, error() holds errno.
+	bool write(const char *data, size_t len);
+	/// Writes out what is buffered.
+	/// \returns False on error, error() holds errno.
+	bool flush();
+	/// Flushes, optionally syncs the data to disk and closes the descriptor;
+	/// the file stays under path() until it is discarded or released.
+	/// \returns False on error, error() holds errno.
+	bool close(bool sync);
+	/// Closes and removes the file.
+	void discard();
+	/// Forgets the file, once its owner renamed it.
+	void release();
+
+	bool isOpen() const { return _fd != -1; }
+	int fd() const { return _fd; }
+	const std::string &path() const { return _path; }
+	/// Bytes written so far, buffered ones included.
+	size_t size() const { return _size; }
+	int error() const { return _error; }
+
+  private:
+	int _fd;
+	std::string _path;
+	std::string _buf;
+	size_t _size;
+	int _error;
+
+	bool writeAll(const char *data, size_t len);
+	bool fail();
+
+	TempFile(const TempFile &);
+	TempFile &operator=(const TempFile &);
+};
+
+#endif /* end of include guard: TEMPFILE_HPP */
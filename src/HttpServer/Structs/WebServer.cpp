@@ -12,6 +12,7 @@
 
 #include "WebServer.hpp"
 #include "Logger/Logger.hpp"
+#include "src/Logger/AccessLog.hpp"
 #include "src/ConfigParser/Structs/Struct.hpp"
 #include "src/HttpServer/HttpServer.hpp"
 #include "src/HttpServer/Structs/Connection.hpp"
@@ -19,32 +20,55 @@
 
 bool WebServer::_running;
 static bool interrupted = false;
+static volatile sig_atomic_t reload_requested = 0;
+static volatile sig_atomic_t upgrade_requested = 0;
+static volatile sig_atomic_t shutdown_requested = 0;
+static volatile sig_atomic_t reopen_requested = 0;
+static volatile sig_atomic_t trace_requested = 0;
 
 WebServer::WebServer(std::vector<ServerConfig> &confs)
-    : _epoll_fd(-1),
+    : drain_timeout(DRAIN_TIMEOUT),
+      trace_file(TRACE_FILE),
+      slow_event_ms(SLOW_EVENT_MS),
+      _epoll_fd(-1),
       _backlog(SOMAXCONN),
       _confs(confs),
+      _config(NULL),
+      _upgrade_fd(-1),
+      _upgrade_pid(-1),
+      _draining(false),
+      _drain_deadline(0),
       _lggr("ws.log", Logger::DEBUG, true) {
-	_lggr.info("An instance of the Webserver was created.");
+	LOG_INFO(_lggr, "An instance of the Webserver was created.");
 }
 
 // DEPRECATED?
-WebServer::WebServer(std::vector<ServerConfig> &confs, std::string &prefix_path, int log_level)
-    : _epoll_fd(-1),
+WebServer::WebServer(std::vector<ServerConfig> &confs, const MimeTypes &types,
+                     std::string &prefix_path, int log_level)
+    : drain_timeout(DRAIN_TIMEOUT),
+      trace_file(TRACE_FILE),
+      slow_event_ms(SLOW_EVENT_MS),
+      _epoll_fd(-1),
       _backlog(SOMAXCONN),
       _root_prefix_path(prefix_path),
       _confs(confs),
+      _types(types),
+      _config(NULL),
+      _upgrade_fd(-1),
+      _upgrade_pid(-1),
+      _draining(false),
+      _drain_deadline(0),
       _lggr("ws.log",
             log_level == 0 ? Logger::ERROR
                            : (log_level == 1     ? Logger::WARNING
                               : (log_level == 2) ? Logger::INFO
                                                  : Logger::DEBUG),
             true) {
-	_lggr.info("An instance of the Webserver was created.");
+	LOG_INFO(_lggr, "An instance of the Webserver was created.");
 }
 
 WebServer::~WebServer() {
-	_lggr.debug("Destroying Webserver instance.");
+	LOG_DEBUG(_lggr, "Destroying Webserver instance.");
 	cleanup();
 }
 
@@ -62,11 +86,12 @@ bool WebServer::initialize() {
 		return false;
 	}
 
-	for (std::vector<ServerConfig>::iterator it = _confs.begin(); it != _confs.end(); ++it) {
-		if (!initializeSingleServer(*it)) {
-			return false;
-		}
+	inheritListeners();
+	if (!openListeners(_confs)) {
+		return false;
 	}
+	compileConfig();
+	notifyUpgradeReady();
 
 	_running = true;
 	return true;
@@ -75,14 +100,47 @@ bool WebServer::initialize() {
 void WebServer::run() {
 	struct epoll_event events[MAX_EVENTS];
 	_last_cleanup = getCurrentTime();
+	_slowest_event = 0;
 
-	_lggr.debug("Server running. Waiting for connections...");
+	LOG_DEBUG(_lggr, "Server running. Waiting for connections...");
 
 	while (_running) {
+		long wait_start = Tracer::enabled() ? Tracer::now() : 0;
 		int event_count = epoll_wait(_epoll_fd, events, MAX_EVENTS, 100);
+		int wait_errno = errno; // the signal work below may overwrite it
+		long busy_start = monotonicUs();
+		if (wait_start)
+			Tracer::record("epoll_wait", "loop", 0, wait_start, busy_start);
+		TraceSpan iteration("iteration", "loop", 0);
+
+		if (reload_requested) {
+			reload_requested = 0;
+			if (!_draining)
+				reloadConfig();
+		}
+		if (upgrade_requested) {
+			upgrade_requested = 0;
+			startUpgrade();
+		}
+		if (shutdown_requested) {
+			shutdown_requested = 0;
+			LOG_INFO(_lggr, "Graceful shutdown requested");
+			startDraining();
+		}
+		if (reopen_requested) {
+			reopen_requested = 0;
+			reopenLogs();
+		}
+		if (trace_requested) {
+			trace_requested = 0;
+			toggleTrace();
+		}
+		if (event_count == -1 && wait_errno == EINTR && !interrupted) {
+			continue;
+		}
 
 		if (event_count == -1 && !interrupted) {
-			_lggr.error("epoll_wait failed: " + std::string(strerror(errno)));
+			_lggr.error("epoll_wait failed: " + std::string(strerror(wait_errno)));
 			break;
 		} else if (event_count == -1 && interrupted) {
 			_lggr.warn("Program interrupted, shutting down...");
@@ -91,7 +149,7 @@ void WebServer::run() {
 
 		if (event_count > 0) {
 			processEpollEvents(events, event_count);
-			// _lggr.debug("Processed " + su::to_string(event_count) + " events");
+			// LOG_DEBUG(_lggr, "Processed " + su::to_string(event_count) + " events");
 			if (event_count == MAX_EVENTS) {
 				_lggr.warn("Hit MAX_EVENTS limit (" + su::to_string(MAX_EVENTS) +
 				           "), may have more events pending");
@@ -99,8 +157,23 @@ void WebServer::run() {
 		}
 
 		cleanupExpiredConnections();
+		closeLingered();
+		AccessLog::flushAll(false);
+		checkLoopLag(busy_start, event_count);
+		if (isDrained()) {
+			LOG_INFO(_lggr, "All connections finished, exiting");
+			break;
+		}
+		if (drainTimedOut()) {
+			_lggr.warn("Drain timeout reached, closing " + su::to_string(_connections.size()) +
+			           " connection(s) and " + su::to_string(_cgi_pool.size()) + " CGI(s)");
+			break;
+		}
 	}
 
+	if (Tracer::enabled())
+		toggleTrace();
+
 	//for (std::vector<ServerConfig>::iterator it = _confs.begin(); it != _confs.end(); ++it) {
 	//	if (it->getServerFD() != -1) {
 	//		close(it->getServerFD());
@@ -114,19 +187,76 @@ void sigint_handler(int sig) {
 	interrupted = true;
 }
 
+void sighup_handler(int sig) {
+	(void)sig;
+	reload_requested = 1;
+}
+
+void sigquit_handler(int sig) {
+	(void)sig;
+	shutdown_requested = 1;
+}
+
+void sigusr2_handler(int sig) {
+	(void)sig;
+	upgrade_requested = 1;
+}
+
+void sigusr1_handler(int sig) {
+	(void)sig;
+	reopen_requested = 1;
+}
+
+void sigprof_handler(int sig) {
+	(void)sig;
+	trace_requested = 1;
+}
+
 bool WebServer::setupSignalHandlers() {
-	_lggr.debug("Setting up signal handlers");
+	LOG_DEBUG(_lggr, "Setting up signal handlers");
+
+	// Response bodies go out with sendfile(), which has no MSG_NOSIGNAL: a client
+	// resetting mid-download must fail that send, not kill the server
+	if (signal(SIGPIPE, SIG_IGN) == SIG_ERR) {
+		_lggr.error("Failed to ignore SIGPIPE");
+		return false;
+	}
 
 	if (signal(SIGINT, &sigint_handler) == SIG_ERR) {
 		_lggr.error("Failed to set SIGINT handler");
 		return false;
 	}
 
-	if (signal(SIGTERM, &sigint_handler) == SIG_ERR) {
+	if (signal(SIGTERM, &sigquit_handler) == SIG_ERR) {
 		_lggr.error("Failed to set SIGTERM handler");
 		return false;
 	}
 
+	if (signal(SIGHUP, &sighup_handler) == SIG_ERR) {
+		_lggr.error("Failed to set SIGHUP handler");
+		return false;
+	}
+
+	if (signal(SIGQUIT, &sigquit_handler) == SIG_ERR) {
+		_lggr.error("Failed to set SIGQUIT handler");
+		return false;
+	}
+
+	if (signal(SIGUSR2, &sigusr2_handler) == SIG_ERR) {
+		_lggr.error("Failed to set SIGUSR2 handler");
+		return false;
+	}
+
+	if (signal(SIGUSR1, &sigusr1_handler) == SIG_ERR) {
+		_lggr.error("Failed to set SIGUSR1 handler");
+		return false;
+	}
+
+	if (signal(SIGPROF, &sigprof_handler) == SIG_ERR) {
+		_lggr.error("Failed to set SIGPROF handler");
+		return false;
+	}
+
 	interrupted = false;
 	return true;
 }
@@ -192,7 +322,7 @@ bool WebServer::setSocketOptions(int socket_fd, const std::string &host, const i
 }
 
 bool WebServer::setNonBlocking(int fd) {
-	_lggr.debug("Setting fd [" + su::to_string(fd) + "] as non-blocking");
+	LOG_DEBUG(_lggr, "Setting fd [" + su::to_string(fd) + "] as non-blocking");
 
 	int flags = fcntl(fd, F_GETFL, 0);
 	if (flags == -1) {
@@ -240,11 +370,11 @@ bool WebServer::epollManage(int op, int socket_fd, uint32_t events) {
 		            "), but encountered an error (" + std::string(strerror(errno)) + ")");
 		return false;
 	}
-	_lggr.debug("Fd: " + su::to_string(socket_fd) +
-	            std::string(op == EPOLL_CTL_ADD   ? " added to epoll instance with mask "
-	                        : op == EPOLL_CTL_MOD ? " modified with new mask "
-	                                              : " deleted from epoll instance.") +
-	            std::string(op == EPOLL_CTL_DEL ? "" : "(" + describeEpollEvents(events) + ")"));
+	LOG_DEBUG(_lggr, "Fd: " + su::to_string(socket_fd) +
+	                 std::string(op == EPOLL_CTL_ADD   ? " added to epoll instance with mask "
+	                             : op == EPOLL_CTL_MOD ? " modified with new mask "
+	                                                   : " deleted from epoll instance.") +
+	                 std::string(op == EPOLL_CTL_DEL ? "" : "(" + describeEpollEvents(events) + ")"));
 
 	return true;
 }
@@ -272,14 +402,123 @@ bool WebServer::initializeSingleServer(ServerConfig &config) {
 	}
 
 	freeaddrinfo(addr_info);
-	_lggr.logWithPrefix(Logger::INFO, config.getHost() + ":" + su::to_string<int>(config.getPort()),
-	                    "Server initialized!");
+	LOG_INFO_P(_lggr, config.getHost() + ":" + su::to_string<int>(config.getPort()),
+	           "Server initialized!");
+
+	return true;
+}
+
+bool WebServer::openListeners(std::vector<ServerConfig> &servers) {
+	std::vector<int> opened;
+	// host:port -> socket, so thousands of servers do not rescan the list for each other
+	std::map<std::string, int> bound;
+	std::map<std::string, int> current;
+	if (_config) {
+		const std::vector<ServerConfig> &running = _config->servers();
+		for (std::vector<ServerConfig>::const_iterator it = running.begin(); it != running.end();
+		     ++it)
+			current.insert(std::make_pair(it->getHost() + ":" + su::to_string(it->getPort()),
+			                              it->getServerFD()));
+	}
 
+	for (std::vector<ServerConfig>::iterator it = servers.begin(); it != servers.end(); ++it) {
+		std::string listen = it->getHost() + ":" + su::to_string(it->getPort());
+		std::map<std::string, int>::const_iterator fd = bound.find(listen);
+		if (fd != bound.end()) {
+			// name-based virtual host: share the socket of the first server on host:port
+			it->setServerFD(fd->second);
+			continue;
+		}
+		fd = current.find(listen);
+		if (fd != current.end()) {
+			// reload: keep the socket, and its pending connections
+			it->setServerFD(fd->second);
+			bound[listen] = fd->second;
+			continue;
+		}
+		bool inherited = takeInheritedListener(*it);
+		if (inherited && epollManage(EPOLL_CTL_ADD, it->getServerFD(), EPOLLIN)) {
+			// binary upgrade: the previous process keeps accepting until we are ready
+			opened.push_back(it->getServerFD());
+			bound[listen] = it->getServerFD();
+			continue;
+		}
+		if (inherited || !initializeSingleServer(*it)) {
+			if (it->getServerFD() != -1)
+				opened.push_back(it->getServerFD());
+			for (size_t i = 0; i < opened.size(); ++i)
+				close(opened[i]);
+			for (std::vector<ServerConfig>::iterator s = servers.begin(); s != servers.end(); ++s)
+				s->setServerFD(-1);
+			return false;
+		}
+		opened.push_back(it->getServerFD());
+		bound[listen] = it->getServerFD();
+	}
 	return true;
 }
 
+void WebServer::reloadConfig() {
+	LOG_INFO(_lggr, "SIGHUP received, reloading " + config_file);
+
+	std::vector<ServerConfig> servers;
+	MimeTypes types;
+	std::string prefix = _root_prefix_path;
+	ConfigParser parser(log_level);
+	if (!parser.loadConfig(config_file, servers, types, prefix, log_level) || servers.empty()) {
+		_lggr.error("Reload failed: invalid configuration in '" + config_file +
+		            "', keeping the current one");
+		return;
+	}
+	if (!openListeners(servers)) {
+		_lggr.error("Reload failed: could not open the new listeners, keeping the current "
+		            "configuration");
+		return;
+	}
+
+	// close the listeners no server uses anymore, accepted connections stay open
+	std::set<int> kept;
+	for (std::vector<ServerConfig>::const_iterator it = servers.begin(); it != servers.end(); ++it)
+		kept.insert(it->getServerFD());
+	const std::map<int, VirtualHosts> &listeners = _config->listeners();
+	for (std::map<int, VirtualHosts>::const_iterator it = listeners.begin();
+	     it != listeners.end(); ++it) {
+		if (!kept.count(it->first)) {
+			epollManage(EPOLL_CTL_DEL, it->first, 0);
+			close(it->first);
+			LOG_INFO_P(_lggr, it->second.defaultServer()->getHost() + ":" +
+			               su::to_string<int>(it->second.defaultServer()->getPort()),
+			           "Listener closed");
+		}
+	}
+
+	_confs = servers;
+	_types = types;
+	compileConfig();
+	LOG_INFO(_lggr, "Configuration reloaded: " + su::to_string(_confs.size()) + " server(s), " +
+	                su::to_string(_connections.size()) +
+	                " open connection(s) finishing on the previous one");
+}
+
+void WebServer::compileConfig() {
+	if (_config)
+		_config->release();
+	assignMetricsSlots();
+	_config = ConfigSnapshot::compile(_confs, _types, _lggr);
+	const std::map<int, VirtualHosts> &listeners = _config->listeners();
+	for (std::map<int, VirtualHosts>::const_iterator it = listeners.begin();
+	     it != listeners.end(); ++it) {
+		if (it->second.size() > 1)
+			LOG_INFO_P(_lggr, it->second.defaultServer()->getHost() + ":" +
+			               su::to_string<int>(it->second.defaultServer()->getPort()),
+			           su::to_string(it->second.size()) + " virtual hosts");
+	}
+}
+
 void WebServer::cleanup() {
-	_lggr.debug("Performing server cleanup...");
+	LOG_DEBUG(_lggr, "Performing server cleanup...");
+
+	killCGIs();
 
 	// Close all client connections
 	for (std::map<int, Connection *>::iterator it = _connections.begin(); it != _connections.end();
@@ -289,73 +528,25 @@ void WebServer::cleanup() {
 	}
 	_connections.clear();
 
+	// virtual hosts share the socket of the first server on their host:port
+	std::set<int> closed;
 	for (std::vector<ServerConfig>::iterator it = _confs.begin(); it != _confs.end(); ++it) {
-		if (it->getServerFD() != -1) {
+		if (it->getServerFD() != -1 && closed.insert(it->getServerFD()).second) {
 			close(it->getServerFD());
-			it->setServerFD(-1);
 		}
 	}
+	for (std::vector<ServerConfig>::iterator it = _confs.begin(); it != _confs.end(); ++it) {
+		it->setServerFD(-1);
+	}
+	if (_config) {
+		_config->release();
+		_config = NULL;
+	}
 
 	if (_epoll_fd != -1) {
 		close(_epoll_fd);
 		_epoll_fd = -1;
 	}
 
-	_lggr.info("Server cleanup completed");
-}
-
-std::string getCurrentWorkingDirectory() {
-	char cwd[PATH_MAX];
-	if (getcwd(cwd, sizeof(cwd)) == NULL) {
-		std::cerr << "Warning: could not resolve current working directory." << std::endl;
-		return "";
-	}
-	std::string dir(cwd);
-	return dir;
-}
-
-int main(int argc, char *argv[]) {
-	ArgumentParser ap;
-	ServerArgs args;
-
-	try {
-		args = ap.parseArgs(argc, argv);
-		if (args.show_help) {
-			ap.printUsage(argv[0]);
-			return 0;
-		}
-		if (args.show_version) {
-			std::cout << __WEBSERV_VERSION__ << std::endl;
-			return 0;
-		}
-		if (args.prefix_path.empty()) {
-			args.prefix_path = getCurrentWorkingDirectory();
-		}
-		std::cout << "prefix_path: " << args.prefix_path << std::endl;
-	} catch (const std::exception &e) {
-		std::cerr << "Error: " << e.what() << std::endl;
-		std::cerr << "Use --help for usage information." << std::endl;
-		return 1;
-	}
-
-	ConfigParser configparser(args.log_level);
-	std::vector<ServerConfig> servers;
-
-	if (!configparser.loadConfig(args.config_file, servers, args.prefix_path, args.log_level)) {
-		std::cerr << "Error: Failed to open or parse configuration file '" << args.config_file
-		          << "'" << std::endl;
-		std::cerr << "Please check the configuration file syntax and try again." << std::endl;
-		return 1;
-	}
-
-	WebServer webserv(servers, args.prefix_path, args.log_level);
-
-    webserv.log_level = args.log_level;
-	if (!webserv.initialize()) {
-		std::cerr << "Failed to initialize web server." << std::endl;
-		return 1;
-	}
-
-	webserv.run();
-	return 0;
+	LOG_INFO(_lggr, "Server cleanup completed");
 }
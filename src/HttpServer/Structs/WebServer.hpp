@@ -14,6 +14,8 @@
 #define WEBSERVER2_HPP
 
 #include "Connection.hpp"
+#include "DirListing.hpp"
+#include "Metrics.hpp"
 #include "Response.hpp"
 #include "includes/Types.hpp"
 #include "src/ConfigParser/ConfigParser.hpp"
@@ -41,8 +43,10 @@ class WebServer {
 	/// !!! DEPRECATED !!!
 	/// Constructs a WebServer with configurations and a root path prefix.
 	/// \param confs Vector of server configurations to initialize.
+	/// \param types MIME table of the configuration.
 	/// \param prefix_path Root directory prefix for serving files.
-	WebServer(std::vector<ServerConfig> &confs, std::string &prefix_path, int log_level);
+	WebServer(std::vector<ServerConfig> &confs, const MimeTypes &types, std::string &prefix_path,
+	          int log_level);
 
 	~WebServer();
 
@@ -56,28 +60,60 @@ class WebServer {
 	/// Global flag indicating if the server should continue running.
 	static bool _running;
 	int log_level;
+	/// Configuration file, read again on SIGHUP.
+	std::string config_file;
+	/// Command line of the process, executed again on SIGUSR2.
+	std::vector<std::string> exec_argv;
+	/// Seconds given to in-flight requests on a graceful shutdown or an upgrade.
+	int drain_timeout;
+	/// Chrome trace written when tracing is switched off (SIGPROF) or at exit.
+	std::string trace_file;
+	/// Event handlers (and loop iterations) taking longer are logged, 0 never.
+	int slow_event_ms;
 
   private:
 	int _epoll_fd;
 	int _backlog;
 	std::string _root_prefix_path;
 
+	/// @brief Parsed servers, bound by initialize() then compiled into _config
 	std::vector<ServerConfig> _confs;
+	/// @brief MIME table parsed with _confs, compiled into _config with them
+	MimeTypes _types;
+	/// @brief Current configuration, shared read-only with the connections
+	ConfigSnapshot *_config;
+
+	/// @brief Binary upgrade (SIGUSR2) and graceful drain
+	std::map<std::string, int> _inherited; // "host:port" -> fd from the previous binary
+	int _upgrade_fd;                       // readiness pipe of the new binary, or -1
+	pid_t _upgrade_pid;
+	bool _draining;                        // not accepting, exits once connections are done
+	time_t _drain_deadline;                // connections still open then are closed
 	std::vector<ServerConfig> _have_pending_conn;
 
 	static const int CONNECTION_TO = 30;   // seconds
+	static const int LINGER_TO = 2;        // seconds, checked on every loop iteration
 	static const int CLEANUP_INTERVAL = 5; // seconds
 	static const int BUFFER_SIZE = 4096 * 3;
 
 	Logger _lggr;
+	std::string _access_line; // reused for every access log line
 	static std::map<uint16_t, std::string> err_messages;
 
 	/// @brief List of all CGI Objects
 	std::map<int, std::pair<CGI *, Connection *> > _cgi_pool;
 
+	/// @brief Autoindex pages, keyed by format and directory path
+	ListingCache _listingCache;
+
+	/// @brief Counters and latency histograms, exported by stub_status locations
+	Metrics _metrics;
+
 	// Connection management arguments
 	std::map<int, Connection *> _connections;
 	time_t _last_cleanup;
+	std::deque<std::pair<int, long> > _lingering; // fd and deadline, in expiry order
+	long _slowest_event; // us, in the current loop iteration
 
 	// MEMBER FUNCTIONS
 
@@ -135,9 +171,112 @@ class WebServer {
 	/// \returns True on successful initialization, false otherwise.
 	bool initializeSingleServer(ServerConfig &config);
 
+	/// Opens the listening sockets of `servers`. A server on a host:port that is
+	/// already open (by an earlier server of `servers`, or by the current
+	/// configuration) shares that socket instead of binding again.
+	/// \returns False if a socket could not be opened; the sockets opened by
+	/// this call are closed again.
+	bool openListeners(std::vector<ServerConfig> &servers);
+
+	/// Compiles the bound servers into the snapshot used to serve requests.
+	void compileConfig();
+
+	/* Handlers/Upgrade.cpp */
+
+	/// Forks and executes exec_argv again (SIGUSR2), handing over the listening
+	/// sockets through the environment. This process drains once the new one
+	/// reports it is accepting, and keeps serving if it fails to start.
+	void startUpgrade();
+
+	/// Reads the readiness pipe of the new binary: one byte when it is
+	/// accepting, end of file when it died first.
+	void handleUpgradeReady();
+
+	/// Collects the listening sockets handed over by a previous binary.
+	void inheritListeners();
+
+	/// Uses the inherited socket of config's host:port, if there is one.
+	/// \returns True if config got an inherited socket.
+	bool takeInheritedListener(ServerConfig &config);
+
+	/// Closes the inherited sockets left unused and tells the previous binary
+	/// this one is accepting.
+	void notifyUpgradeReady();
+
+	/* Handlers/Shutdown.cpp */
+
+	/// Stops accepting, closes idle connections and lets the others (CGIs
+	/// included) finish their current request. run() returns once isDrained(),
+	/// or after drain_timeout seconds.
+	void startDraining();
+	bool isDrained() const;
+	bool drainTimedOut() const;
+
+	/// Kills and reaps the CGI children still running, on exit.
+	void killCGIs();
+
+	/// Re-reads config_file (SIGHUP) and serves new requests with it, while
+	/// accepted connections finish on the previous snapshot. Listeners that
+	/// are gone are closed. A broken file or a failed bind keeps the current
+	/// configuration.
+	void reloadConfig();
+
 	/// Performs cleanup of all server resources and connectioqns.
 	void cleanup();
 
+	/* Handlers/AccessLogging.cpp */
+
+	/// Appends the finished (or failed) response of conn to the access_log of
+	/// its server, in the configured format and sampling, and to the trace.
+	void logAccess(Connection *conn);
+
+	/// Reopens the access logs and ws.log (SIGUSR1), after logrotate moved them.
+	void reopenLogs();
+
+	/// Starts tracing, or stops it and writes trace_file (SIGPROF).
+	void toggleTrace();
+
+	/* Handlers/StatusReq.cpp */
+
+	/// Counts the finished (or failed) response of conn in the metrics of its
+	/// location.
+	void recordMetrics(Connection *conn);
+
+	/// Gives every server and location of _confs its metrics slot.
+	void assignMetricsSlots();
+
+	/// \returns The stub_status page, in the location's format.
+	Response respStubStatus(Connection *conn);
+
+	/* Handlers/UploadReq.cpp */
+
+	/// Sets conn->upload when the request is a multipart POST or a PUT to a
+	/// location with `upload on`, so its body streams to disk.
+	/// \returns False if an error response was prepared (no boundary, no
+	/// upload directory, PUT target refused).
+	bool startUpload(ClientRequest &req, Connection *conn);
+
+	/// Opens the temporary file of a PUT, reserving Content-Length bytes.
+	/// \returns False if an error response was prepared.
+	bool startPut(ClientRequest &req, Connection *conn);
+
+	/// Prepares the error response of a failed upload and marks the
+	/// connection to close, the rest of the body is not read.
+	/// \returns True, the request is complete.
+	bool uploadError(Connection *conn);
+
+	/// \returns 201 listing the saved files, or 400 for an incomplete body or
+	/// one without files. Releases conn->upload.
+	Response respUpload(Connection *conn);
+
+	/// Moves the PUT body over its target. Releases conn->upload.
+	/// \returns 201 for a new file, 204 for a replaced one.
+	Response respPut(ClientRequest &req, Connection *conn);
+
+	/// Removes a file of upload_path.
+	/// \returns 204, or 404/403/409 when it can't be removed.
+	Response respDelete(ClientRequest &req, Connection *conn);
+
 	/* Request.cpp */
 
 	void processValidRequest(ClientRequest &req, Connection *conn);
@@ -148,8 +287,13 @@ class WebServer {
 	bool handleFileSystemErrors(FileType file_type, const std::string &full_path, Connection *conn);
 	bool normalizePath(ClientRequest &req, Connection *conn);
 	bool matchLocation(ClientRequest &req, Connection *conn);
+	void selectServer(ClientRequest &req, Connection *conn);
 
-	bool reconstructRequest(Connection *conn);
+	/// Checks whether the whole Content-Length body has arrived.
+	/// \param conn The connection reading a body.
+	/// \returns True once complete (or a 400 is prepared for extra bytes),
+	/// false if more data is needed.
+	bool isBodyComplete(Connection *conn);
 
 
 	uint16_t handleCGIRequest(ClientRequest &req, Connection *conn);
@@ -170,6 +314,11 @@ class WebServer {
 	/// \returns True if headers are complete, false otherwise.
 	bool isHeadersComplete(Connection *conn);
 
+	/// Answers `Expect: 100-continue` once the headers passed every check,
+	/// unless the body already started to arrive.
+	/// \param body_start Offset of the body in conn->read_buffer.
+	void sendContinue(const ClientRequest &req, Connection *conn, size_t body_start);
+
 	/// Determines if a complete HTTP request has been received.
 	/// \param conn The connection to check.
 	/// \returns True if request is complete, false if more data is needed.
@@ -197,28 +346,20 @@ class WebServer {
 	/// \returns File content as string, or empty string on error.
 	std::string getFileContent(std::string path);
 	FileType checkFileType(const std::string &path);
-	std::string buildFullPath(const std::string &uri, LocConfig *Location);
+	std::string buildFullPath(const std::string &uri, const LocConfig *Location);
 
 	/* Handlers/ChunkedReq.cpp */
 
-	/// Processes chunked transfer encoding chunk size line.
-	/// \param conn The connection receiving chunked data.
-	/// \returns True if chunk size was successfully parsed, false otherwise.
-	bool processChunkSize(Connection *conn);
-
-	/// Processes chunked transfer encoding data chunks.
-	/// \param conn The connection receiving chunked data.
-	/// \returns True if chunk data was processed successfully, false otherwise.
-	bool processChunkData(Connection *conn);
-
-	/// Processes trailing headers in chunked transfer encoding.
+	/// Decodes the chunked body received so far, appending it to conn->body.
 	/// \param conn The connection receiving chunked data.
-	/// \returns True if trailer was processed successfully, false otherwise.
-	bool processTrailer(Connection *conn);
+	/// \returns True once the body is complete or an error response is
+	/// prepared, false if more data is needed.
+	bool decodeChunked(Connection *conn);
 
-	/// Reconstructs a complete request from chunked transfer encoding.
-	/// \param conn The connection that received chunked data.
-	void reconstructChunkedRequest(Connection *conn);
+	/// Prepares an error response for a malformed or oversized chunked body
+	/// and marks the connection to close, the stream can't be resynchronized.
+	/// \returns True, the request is complete.
+	bool chunkError(Connection *conn, uint16_t code);
 
 	/* Handlers/ServerCGI.cpp */
 	bool prepareCGIResponse(CGI *cgi, Connection *conn);
@@ -230,18 +371,25 @@ class WebServer {
 	void updateConnectionActivity(int client_fd);
 
 	/// Accepts a new client connection and adds it to the connection pool.
-	/// \param sc Pointer to the server configuration that received the connection.
-	void handleNewConnection(ServerConfig *sc);
+	/// \param listen_fd The listening socket that received the connection.
+	/// \param vh The servers sharing that socket.
+	void handleNewConnection(int listen_fd, const VirtualHosts *vh);
 
 	/// Creates and registers a new client connection.
 	/// \param client_fd The client socket file descriptor.
-	/// \param sc The configuaration struct for the matching host:port server
-	/// \returns Pointer to the newly created Connection object.
-	Connection *addConnection(int client_fd, ServerConfig *sc);
+	/// \param vh The servers of the listening socket; the default one is used
+	/// until a Host header selects another.
+	/// \returns Pointer to the newly created Connection object, holding a
+	/// reference to the current configuration snapshot.
+	Connection *addConnection(int client_fd, const VirtualHosts *vh);
 
 	/// Closes expired connections to free resources.
 	void cleanupExpiredConnections();
 
+	/// Closes the lingering connections whose LINGER_TO passed. Cheap enough
+	/// for every loop iteration: only the expired ones are looked at.
+	void closeLingered();
+
 	/// Handles connection timeout by preparing appropriate response.
 	/// \param client_fd The file descriptor of the timed-out connection.
 	void handleConnectionTimeout(int client_fd);
@@ -250,6 +398,11 @@ class WebServer {
 	/// \param conn Pointer to the connection to close.
 	void closeConnection(Connection *conn);
 
+	/// Closes a connection whose request was refused before its body was
+	/// read: stops writing and discards the input until the client closes or
+	/// LINGER_TO passes, so the unread body doesn't reset the response.
+	void lingerClose(Connection *conn);
+
 	/* Handlers/DirectoryReq.cpp */
 
 	/// Prepares response data when a directory is requested
@@ -270,6 +423,17 @@ class WebServer {
 	/// \returns Response object containing the requested resource or error.
 	Response respFileRequest(Connection *conn, const std::string &fullFilePath);
 
+	/// Prepares a 206 (single range or multipart/byteranges) or 416 response
+	/// \param conn The connection to send response to.
+	/// \param fd The open file, owned by the returned response (closed on 416).
+	/// \param st The file status used for Content-Range and validators.
+	/// \param fullFilePath The full path to the file to send.
+	/// \param ranges Inclusive byte ranges, empty when not satisfiable.
+	/// \returns Response object containing the requested ranges or error.
+	Response respRangeRequest(Connection *conn, int fd, const struct stat &st,
+	                          const std::string &fullFilePath,
+	                          const std::vector<std::pair<off_t, off_t> > &ranges);
+
 	/// Handles Return directives
 	/// \param req The GET request to process.
 	/// \param code The status code to send back.
@@ -284,6 +448,14 @@ class WebServer {
 	/// \param event_count Number of events in the array.
 	void processEpollEvents(const struct epoll_event *events, int event_count);
 
+	/// Logs an event handler that blocked the loop for `us`, with the request
+	/// of client_fd when it is still open.
+	void reportSlowEvent(int kind, int fd, int client_fd, long us);
+
+	/// Counts the busy time of the iteration started at busy_start and logs it
+	/// when it is slow without a single slow event to blame.
+	void checkLoopLag(long busy_start, int event_count);
+
 	/// Determines if a file descriptor belongs to a listening socket.
 	/// \param fd The file descriptor to check.
 	/// \returns True if fd is a listening socket, false otherwise.
@@ -313,6 +485,15 @@ class WebServer {
 	/// \returns True if processing succeeded, false on error.
 	bool processReceivedData(Connection *conn, const char *buffer, ssize_t bytes_read);
 
+	/// Answers the request in the read buffer once it is complete.
+	/// \returns False if the connection is to be closed after the response.
+	bool serveRequest(Connection *conn);
+
+	/// Starts on the request left in the read buffer after a response went
+	/// out: no EPOLLIN announces bytes that were read along with the last one.
+	/// \returns False if the connection is to be closed after the response.
+	bool servePipelined(Connection *conn);
+
 	/* Handlers/MethodsHandler.cpp */
 
 	/// Prepares response data for transmission to client.
@@ -321,9 +502,21 @@ class WebServer {
 	/// \returns Number of bytes prepared for sending, or negative on error.
 	ssize_t prepareResponse(Connection *conn, const Response &resp);
 
-	/// Sends prepared response data to client.
+	/// Serializes the prepared response into the connection's send queue.
+	/// \param conn The connection holding the prepared response.
+	void queueResponse(Connection *conn);
+
+	/// Gzip-encodes a 200 response when the location enables `gzip`, the
+	/// content type is listed in `gzip_types` and the client accepts it.
+	/// In-memory bodies are compressed at once, file bodies and streams are
+	/// compressed while being sent.
+	/// \param conn The connection holding the prepared response.
+	void applyContentEncoding(Connection *conn);
+
+	/// Sends as much of the prepared response as the socket accepts.
+	/// The response stays ready until its last byte (or file range) is sent.
 	/// \param conn The connection to send response to.
-	/// \returns True if response was sent successfully, false otherwise.
+	/// \returns False on a send error, true otherwise.
 	bool sendResponse(Connection *conn);
 };
 
@@ -0,0 +1,116 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   AccessLog.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 13:10:42 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 13:10:42 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/Logger/AccessLog.hpp"
+#include "src/Logger/Logger.hpp"
+
+std::map<std::string, AccessLog *> AccessLog::_open;
+
+AccessLog::AccessLog(const std::string &path, int fd)
+    : _path(path),
+      _fd(fd),
+      _buffer(0),
+      _flush_ms(0),
+      _pending_since(0),
+      _seen(0),
+      _refs(0) {}
+
+AccessLog::~AccessLog() {
+	flush();
+	close(_fd);
+}
+
+AccessLog *AccessLog::acquire(const std::string &path, size_t buffer, long flush_ms) {
+	AccessLog *log;
+	std::map<std::string, AccessLog *>::iterator it = _open.find(path);
+	if (it != _open.end())
+		log = it->second;
+	else {
+		int fd = openFile(path);
+		if (fd == -1)
+			return NULL;
+		log = new AccessLog(path, fd);
+		_open[path] = log;
+	}
+	log->_buffer = buffer;
+	log->_flush_ms = flush_ms;
+	log->_pending.reserve(buffer);
+	++log->_refs;
+	return log;
+}
+
+void AccessLog::release() {
+	if (--_refs > 0)
+		return;
+	_open.erase(_path);
+	delete this;
+}
+
+void AccessLog::append(const std::string &line) {
+	if (_pending.empty())
+		_pending_since = nowMs();
+	_pending += line;
+	if (_pending.size() >= _buffer || (_flush_ms > 0 && nowMs() - _pending_since >= _flush_ms))
+		flush();
+}
+
+bool AccessLog::sample(unsigned rate) { return rate <= 1 || _seen++ % rate == 0; }
+
+void AccessLog::flushAll(bool force) {
+	long now = force ? 0 : nowMs();
+	for (std::map<std::string, AccessLog *>::iterator it = _open.begin(); it != _open.end();
+	     ++it) {
+		AccessLog *log = it->second;
+		if (log->_pending.empty())
+			continue;
+		if (force || (log->_flush_ms > 0 && now - log->_pending_since >= log->_flush_ms))
+			log->flush();
+	}
+}
+
+void AccessLog::reopenAll(Logger &lggr) {
+	for (std::map<std::string, AccessLog *>::iterator it = _open.begin(); it != _open.end();
+	     ++it) {
+		AccessLog *log = it->second;
+		log->flush();
+		int fd = openFile(log->_path);
+		if (fd == -1) {
+			lggr.warn("Could not reopen access log " + log->_path + ": " + strerror(errno));
+			continue; // keep writing to the old file
+		}
+		close(log->_fd);
+		log->_fd = fd;
+	}
+}
+
+void AccessLog::flush() {
+	size_t done = 0;
+	while (done < _pending.size()) {
+		ssize_t n = write(_fd, _pending.data() + done, _pending.size() - done);
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break; // disk full or file gone: the lines are lost, the server carries on
+		done += n;
+	}
+	_pending.clear();
+}
+
+int AccessLog::openFile(const std::string &path) {
+	return open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+}
+
+long AccessLog::nowMs() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000L + tv.tv_usec / 1000;
+}
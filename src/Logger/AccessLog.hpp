@@ -0,0 +1,74 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   AccessLog.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 13:10:42 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 13:10:42 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef ACCESSLOG_HPP
+#define ACCESSLOG_HPP
+
+#include "includes/Webserv.hpp"
+
+class Logger;
+
+/**
+ * Access log file, shared by every server (and configuration snapshot)
+ * logging to the same path.
+ *
+ * Lines are appended to an in-memory buffer and written with one write()
+ * once it holds `buffer` bytes or its oldest line is `flush` ms old, so a
+ * busy server does not pay a syscall per request. Unbuffered logs (buffer 0)
+ * write every line as it comes.
+ *
+ * Files are reference counted: each snapshot holds one reference per server
+ * using it, and the last release flushes and closes the file. reopenAll()
+ * reopens every file under its path, for log rotation (SIGUSR1).
+ */
+class AccessLog {
+  public:
+	/// Opens `path`, or shares it if it is already open. The latest settings win.
+	/// \returns NULL if the file cannot be opened.
+	static AccessLog *acquire(const std::string &path, size_t buffer, long flush_ms);
+	/// Drops a reference, flushing and closing the file with the last one.
+	void release();
+
+	/// Buffers one line (newline included).
+	void append(const std::string &line);
+	/// Counts a request and tells whether it is the one in `rate` to log.
+	bool sample(unsigned rate);
+
+	/// Writes out buffered lines: all of them if `force`, else the overdue ones.
+	static void flushAll(bool force);
+	/// Flushes and reopens every file, after logrotate moved them away. A file
+	/// that can't be reopened is reported to `lggr` and keeps the old one.
+	static void reopenAll(Logger &lggr);
+
+  private:
+	std::string _path;
+	int _fd;
+	size_t _buffer;
+	long _flush_ms;
+	std::string _pending;
+	long _pending_since; // ms timestamp of the oldest buffered line
+	unsigned long _seen; // requests counted by sample()
+	int _refs;
+
+	static std::map<std::string, AccessLog *> _open;
+
+	AccessLog(const std::string &path, int fd);
+	~AccessLog();
+	AccessLog(const AccessLog &);
+	AccessLog &operator=(const AccessLog &);
+
+	void flush();
+	static int openFile(const std::string &path);
+	static long nowMs();
+};
+
+#endif
@@ -0,0 +1,213 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LogWriter.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 12:05:11 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 12:05:11 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/Logger/LogWriter.hpp"
+#include "src/Utils/StringUtils.hpp"
+
+LogWriter &LogWriter::instance() {
+	static LogWriter writer;
+	return writer;
+}
+
+LogWriter::LogWriter()
+    : _ring(NULL),
+      _size(4096),
+      _head(0),
+      _tail(0),
+      _overflow(BLOCK),
+      _dropped(0),
+      _threaded(false),
+      _stop(0),
+      _sleeping(0) {
+	while (_size < LOG_BUFFER_SIZE)
+		_size *= 2;
+	_ring = new char[_size];
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_wake, NULL);
+
+	// signals stay with the event loop thread
+	sigset_t all, previous;
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &previous);
+	_threaded = pthread_create(&_thread, NULL, &LogWriter::run, this) == 0;
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	pthread_atfork(NULL, NULL, &LogWriter::afterFork);
+}
+
+LogWriter::~LogWriter() {
+	if (_threaded) {
+		_stop = 1;
+		wakeWriter();
+		pthread_join(_thread, NULL);
+	}
+	pthread_cond_destroy(&_wake);
+	pthread_mutex_destroy(&_mutex);
+	delete[] _ring;
+}
+
+void LogWriter::setOverflow(Overflow policy) { _overflow = policy; }
+
+void LogWriter::write(int fd, const char *data, size_t len) {
+	if (!_threaded) {
+		writeAll(fd, data, len);
+		return;
+	}
+	// a line that would hog the ring (config dumps) goes out directly, after what is queued
+	if (sizeof(Record) + len > _size / 2) {
+		flush();
+		writeAll(fd, data, len);
+		return;
+	}
+	if (_dropped) {
+		std::string note = "[LogWriter] " + su::to_string(_dropped) +
+		                   " log line(s) dropped, the buffer was full\n";
+		if (!enqueue(fd, note.data(), note.size())) {
+			++_dropped;
+			return;
+		}
+		_dropped = 0;
+	}
+	if (!enqueue(fd, data, len))
+		++_dropped;
+}
+
+void LogWriter::flush() {
+	if (!_threaded)
+		return;
+	size_t target = _head;
+	while (_tail != target) {
+		if (_sleeping)
+			wakeWriter();
+		usleep(100);
+	}
+}
+
+bool LogWriter::enqueue(int fd, const char *data, size_t len) {
+	size_t need = sizeof(Record) + len;
+	while (_size - (_head - _tail) < need) {
+		if (_overflow == DROP)
+			return false;
+		if (_sleeping)
+			wakeWriter();
+		usleep(100);
+	}
+	Record rec;
+	rec.fd = fd;
+	rec.len = len;
+	copyIn(_head, &rec, sizeof(rec));
+	copyIn(_head + sizeof(rec), data, len);
+	__sync_synchronize();
+	_head = _head + need;
+	__sync_synchronize();
+	// the writer drains every LOG_FLUSH_INTERVAL ms on its own; waking it per
+	// line would cost a context switch per line, so only hurry it up when full
+	if (_sleeping && _head - _tail > _size / 4)
+		wakeWriter();
+	return true;
+}
+
+void LogWriter::wakeWriter() {
+	pthread_mutex_lock(&_mutex);
+	pthread_cond_signal(&_wake);
+	pthread_mutex_unlock(&_mutex);
+}
+
+void LogWriter::copyIn(size_t pos, const void *data, size_t len) {
+	size_t offset = pos & (_size - 1);
+	size_t first = std::min(len, _size - offset);
+	std::memcpy(_ring + offset, data, first);
+	std::memcpy(_ring, static_cast<const char *>(data) + first, len - first);
+}
+
+void LogWriter::copyOut(size_t pos, void *data, size_t len) const {
+	size_t offset = pos & (_size - 1);
+	size_t first = std::min(len, _size - offset);
+	std::memcpy(data, _ring + offset, first);
+	std::memcpy(static_cast<char *>(data) + first, _ring, len - first);
+}
+
+// Writer thread: one write() per run of lines going to the same fd
+void LogWriter::drain() {
+	static char batch[65536];
+	size_t head = _head;
+	__sync_synchronize();
+	size_t tail = _tail;
+	size_t used = 0;
+	int fd = -1;
+
+	while (tail != head) {
+		Record rec;
+		copyOut(tail, &rec, sizeof(rec));
+		size_t pos = tail + sizeof(rec);
+		if (rec.fd != fd || used + rec.len > sizeof(batch)) {
+			writeAll(fd, batch, used);
+			used = 0;
+			fd = rec.fd;
+		}
+		if (rec.len > sizeof(batch)) {
+			size_t offset = pos & (_size - 1);
+			size_t first = std::min(static_cast<size_t>(rec.len), _size - offset);
+			writeAll(fd, _ring + offset, first);
+			writeAll(fd, _ring, rec.len - first);
+		} else {
+			copyOut(pos, batch + used, rec.len);
+			used += rec.len;
+		}
+		tail = pos + rec.len;
+	}
+	writeAll(fd, batch, used);
+	__sync_synchronize();
+	_tail = tail;
+}
+
+void *LogWriter::run(void *arg) {
+	LogWriter *self = static_cast<LogWriter *>(arg);
+
+	for (;;) {
+		if (self->_head != self->_tail)
+			self->drain();
+		if (self->_stop)
+			break;
+		pthread_mutex_lock(&self->_mutex);
+		self->_sleeping = 1;
+		__sync_synchronize();
+		if (self->_head - self->_tail <= self->_size / 4 && !self->_stop) {
+			struct timespec deadline;
+			clock_gettime(CLOCK_REALTIME, &deadline);
+			deadline.tv_nsec += LOG_FLUSH_INTERVAL * 1000000L;
+			if (deadline.tv_nsec >= 1000000000) {
+				deadline.tv_sec += 1;
+				deadline.tv_nsec -= 1000000000;
+			}
+			pthread_cond_timedwait(&self->_wake, &self->_mutex, &deadline);
+		}
+		self->_sleeping = 0;
+		pthread_mutex_unlock(&self->_mutex);
+	}
+	self->drain();
+	return NULL;
+}
+
+// the writer thread does not survive fork(): the child (CGI, upgrade) writes synchronously
+void LogWriter::afterFork() { instance()._threaded = false; }
+
+void LogWriter::writeAll(int fd, const char *data, size_t len) {
+	while (len > 0 && fd >= 0) {
+		ssize_t n = ::write(fd, data, len);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return;
+		data += n;
+		len -= n;
+	}
+}
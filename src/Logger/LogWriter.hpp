@@ -0,0 +1,79 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LogWriter.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 12:05:11 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 12:05:11 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef LOGWRITER_HPP
+#define LOGWRITER_HPP
+
+#include "includes/Webserv.hpp"
+
+/**
+ * Background writer shared by every Logger.
+ *
+ * Loggers hand it preformatted lines; they are copied into a single-producer
+ * single-consumer ring and a thread writes them out every LOG_FLUSH_INTERVAL
+ * ms (sooner when the ring fills up), coalescing consecutive lines for the
+ * same fd into one write(). The event loop only pays for a memcpy.
+ *
+ * write() must only be called from the event-loop thread: the ring has a
+ * single producer, which is what makes it lock-free. The mutex is only
+ * touched to wake a sleeping writer.
+ *
+ * Without a writer thread (it could not be started, or we are a forked
+ * child) lines are written synchronously.
+ */
+class LogWriter {
+  public:
+	enum Overflow { BLOCK, DROP }; // when the ring is full: wait for the writer, or lose the line
+
+	static LogWriter &instance();
+
+	void write(int fd, const char *data, size_t len); // event-loop thread only
+	void flush(); // returns once everything queued so far has been written
+	void setOverflow(Overflow policy);
+
+  private:
+	struct Record {
+		int fd;
+		uint32_t len;
+	};
+
+	char *_ring;
+	size_t _size; // power of two
+	volatile size_t _head; // written by the producer only
+	volatile size_t _tail; // written by the writer thread only
+	Overflow _overflow;
+	size_t _dropped;
+
+	pthread_t _thread;
+	bool _threaded;
+	volatile int _stop;
+	volatile int _sleeping;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _wake;
+
+	LogWriter();
+	~LogWriter();
+	LogWriter(const LogWriter &);
+	LogWriter &operator=(const LogWriter &);
+
+	bool enqueue(int fd, const char *data, size_t len);
+	void wakeWriter();
+	void copyIn(size_t pos, const void *data, size_t len);
+	void copyOut(size_t pos, void *data, size_t len) const;
+	void drain();
+
+	static void *run(void *arg);
+	static void afterFork();
+	static void writeAll(int fd, const char *data, size_t len);
+};
+
+#endif
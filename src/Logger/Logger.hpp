@@ -14,6 +14,7 @@
 #define LOGGER_HPP
 
 #include "includes/Webserv.hpp"
+#include "src/Logger/LogWriter.hpp"
 
 class Logger {
   public:
@@ -23,11 +24,13 @@ class Logger {
 	    : minLevel(minLogLevel),
 	      consoleOutput(enableConsole),
 	      fileOutput(false),
-	      logFileName(filename) {
+	      logFd(-1),
+	      logFileName(filename),
+	      stampTime(-1) {
 
 		if (!filename.empty()) {
-			logFile.open(filename.c_str(), std::ios::app);
-			if (logFile.is_open()) {
+			logFd = open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+			if (logFd != -1) {
 				fileOutput = true;
 			} else {
 				std::cerr << "Warning: Could not open log file: " << filename << std::endl;
@@ -36,8 +39,10 @@ class Logger {
 	}
 
 	~Logger() {
-		if (logFile.is_open()) {
-			logFile.close();
+		if (logFd != -1) {
+			// lines still queued for this fd must reach it before it is closed
+			LogWriter::instance().flush();
+			close(logFd);
 		}
 	}
 
@@ -48,30 +53,35 @@ class Logger {
 	void setConsoleOutput(bool enable) { consoleOutput = enable; }
 
 	// Enable/disable file output
-	void setFileOutput(bool enable) { fileOutput = enable && logFile.is_open(); }
+	void setFileOutput(bool enable) { fileOutput = enable && logFd != -1; }
+
+	// Reopen the file under its name after log rotation moved it. The new file
+	// takes over the same fd number, queued lines are flushed to the old one first
+	bool reopen() {
+		if (logFd == -1)
+			return false;
+		int fd = open(logFileName.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+		if (fd == -1)
+			return false;
+		LogWriter::instance().flush();
+		dup2(fd, logFd);
+		fcntl(logFd, F_SETFD, FD_CLOEXEC);
+		close(fd);
+		return true;
+	}
+
+	// What to do when the background writer falls behind (all loggers)
+	static void setOverflowPolicy(LogWriter::Overflow policy) {
+		LogWriter::instance().setOverflow(policy);
+	}
 
 	// Main logging function
 	void log(LogLevel level, const std::string &message) {
 		if (level < minLevel) {
 			return;
 		}
-
-		std::string formattedMessage = formatMessage(level, message);
-
-		// Output to console
-		if (consoleOutput) {
-			if (level >= ERROR) {
-				std::cerr << formattedMessage << std::endl;
-			} else {
-				std::cout << formattedMessage << std::endl;
-			}
-		}
-
-		// Output to file
-		if (fileOutput && logFile.is_open()) {
-			logFile << formattedMessage << std::endl;
-			logFile.flush(); // Ensure immediate write
-		}
+		formatMessage(level, NULL, message);
+		emit(level);
 	}
 
 	// Convenience methods for different log levels
@@ -87,9 +97,11 @@ class Logger {
 
 	// Log with custom prefix (useful for different modules)
 	void logWithPrefix(LogLevel level, const std::string &prefix, const std::string &message) {
-		std::stringstream ss;
-		ss << "[" << prefix << "] " << message;
-		log(level, ss.str());
+		if (level < minLevel) {
+			return;
+		}
+		formatMessage(level, &prefix, message);
+		emit(level);
 	}
 
 	// Get current log level
@@ -99,50 +111,114 @@ class Logger {
 	bool isLevelEnabled(LogLevel level) const { return level >= minLevel; }
 
   private:
-	std::ofstream logFile;
 	LogLevel minLevel;
 	bool consoleOutput;
 	bool fileOutput;
+	int logFd;
 	std::string logFileName;
-
-	// Get current timestamp as string
-	std::string getCurrentTime() const {
-		time_t rawtime;
-		struct tm *timeinfo;
-		char buffer[80];
-
-		time(&rawtime);
-		timeinfo = localtime(&rawtime);
-
-		strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", timeinfo);
-		return std::string(buffer);
+	std::string line;    // reused for every record
+	time_t stampTime;    // second the cached stamp was formatted for
+	char stamp[32];      // "[%Y-%m-%d %H:%M:%S] "
+
+	Logger(const Logger &);
+	Logger &operator=(const Logger &);
+
+	// Current timestamp, formatted at most once per second
+	const char *getCurrentTime() {
+		time_t now = time(NULL);
+		if (now != stampTime) {
+			struct tm timeinfo;
+			localtime_r(&now, &timeinfo);
+			strftime(stamp, sizeof(stamp), "[%Y-%m-%d %H:%M:%S] ", &timeinfo);
+			stampTime = now;
+		}
+		return stamp;
 	}
 
 	// Convert log level to string
-	std::string levelToString(LogLevel level) const {
+	static const char *levelToString(LogLevel level) {
 		switch (level) {
 		case DEBUG:
-			return "DEBUG";
+			return "[DEBUG] ";
 		case INFO:
-			return "INFO";
+			return "[INFO] ";
 		case WARNING:
-			return "WARNING";
+			return "[WARNING] ";
 		case ERROR:
-			return "ERROR";
+			return "[ERROR] ";
 		case CRITICAL:
-			return "CRITICAL";
+			return "[CRITICAL] ";
 		default:
-			return "UNKNOWN";
+			return "[UNKNOWN] ";
 		}
 	}
 
-	// Format the log message
-	std::string formatMessage(LogLevel level, const std::string &message) const {
-		std::stringstream ss;
-		ss << "[" << getCurrentTime() << "] "
-		   << "[" << levelToString(level) << "] " << message;
-		return ss.str();
+	// Format the log message into line
+	void formatMessage(LogLevel level, const std::string *prefix, const std::string &message) {
+		line.clear();
+		line += getCurrentTime();
+		line += levelToString(level);
+		if (prefix) {
+			line += '[';
+			line += *prefix;
+			line += "] ";
+		}
+		line += message;
+		line += '\n';
+	}
+
+	// Hand the formatted line to the background writer
+	void emit(LogLevel level) {
+		if (consoleOutput)
+			LogWriter::instance().write(level >= ERROR ? STDERR_FILENO : STDOUT_FILENO,
+			                            line.data(), line.size());
+		if (fileOutput)
+			LogWriter::instance().write(logFd, line.data(), line.size());
 	}
 };
 
+/*
+ * Logging macros: the message expression is only evaluated when the level is
+ * enabled, so a disabled LOG_DEBUG does not build its string. Levels below
+ * LOG_MIN_LEVEL (make LOG_LEVEL=n) are compiled out altogether.
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
+#define LOG_AT(lggr, level, msg)                                                                  \
+	do {                                                                                           \
+		if ((lggr).isLevelEnabled(level))                                                          \
+			(lggr).log(level, msg);                                                                \
+	} while (0)
+
+#define LOG_PREFIX_AT(lggr, level, prefix, msg)                                                   \
+	do {                                                                                           \
+		if ((lggr).isLevelEnabled(level))                                                          \
+			(lggr).logWithPrefix(level, prefix, msg);                                              \
+	} while (0)
+
+#define LOG_DISABLED() ((void)0)
+
+#if LOG_MIN_LEVEL <= 0
+#define LOG_DEBUG(lggr, msg) LOG_AT(lggr, Logger::DEBUG, msg)
+#define LOG_DEBUG_P(lggr, prefix, msg) LOG_PREFIX_AT(lggr, Logger::DEBUG, prefix, msg)
+#else
+#define LOG_DEBUG(lggr, msg) LOG_DISABLED()
+#define LOG_DEBUG_P(lggr, prefix, msg) LOG_DISABLED()
+#endif
+
+#if LOG_MIN_LEVEL <= 1
+#define LOG_INFO(lggr, msg) LOG_AT(lggr, Logger::INFO, msg)
+#define LOG_INFO_P(lggr, prefix, msg) LOG_PREFIX_AT(lggr, Logger::INFO, prefix, msg)
+#else
+#define LOG_INFO(lggr, msg) LOG_DISABLED()
+#define LOG_INFO_P(lggr, prefix, msg) LOG_DISABLED()
+#endif
+
+#define LOG_WARN(lggr, msg) LOG_AT(lggr, Logger::WARNING, msg)
+#define LOG_WARN_P(lggr, prefix, msg) LOG_PREFIX_AT(lggr, Logger::WARNING, prefix, msg)
+#define LOG_ERROR(lggr, msg) LOG_AT(lggr, Logger::ERROR, msg)
+#define LOG_ERROR_P(lggr, prefix, msg) LOG_PREFIX_AT(lggr, Logger::ERROR, prefix, msg)
+
 #endif // LOGGER_HPP
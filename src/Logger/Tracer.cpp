@@ -0,0 +1,152 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Tracer.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:05:12 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 14:05:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/Logger/Tracer.hpp"
+#include "src/Utils/ServerUtils.hpp"
+
+bool Tracer::_enabled = false;
+std::vector<Tracer::Event> Tracer::_ring;
+size_t Tracer::_next = 0;
+size_t Tracer::_count = 0;
+
+void Tracer::start() {
+	_ring.resize(TRACE_EVENTS);
+	_next = 0;
+	_count = 0;
+	_enabled = true;
+}
+
+long Tracer::now() { return monotonicUs(); }
+
+Tracer::Event &Tracer::slot() {
+	Event &event = _ring[_next];
+	_next = (_next + 1) % _ring.size();
+	++_count;
+	return event;
+}
+
+static void copyDetail(char *out, const std::string &detail) {
+	size_t len = std::min(detail.size(), static_cast<size_t>(TRACE_DETAIL_SIZE - 1));
+	std::memcpy(out, detail.data(), len);
+	out[len] = '\0';
+}
+
+void Tracer::record(const char *name, const char *cat, int tid, long begin_us, long end_us,
+                    const std::string &detail) {
+	if (!_enabled)
+		return;
+	Event &event = slot();
+	event.name = name;
+	event.cat = cat;
+	event.tid = tid;
+	event.async = false;
+	event.ts = begin_us;
+	event.dur = end_us - begin_us;
+	copyDetail(event.detail, detail);
+}
+
+void Tracer::request(int tid, long begin_us, long end_us, const std::string &detail) {
+	record("request", "http", tid, begin_us, end_us, detail);
+	if (_enabled)
+		_ring[(_next + _ring.size() - 1) % _ring.size()].async = true;
+}
+
+static void appendJson(std::string &out, const char *str) {
+	for (; *str; ++str) {
+		unsigned char c = *str;
+		if (c == '"' || c == '\\') {
+			out += '\\';
+			out += c;
+		} else if (c < 0x20 || c == 0x7f) {
+			char buf[8];
+			std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+			out += buf;
+		} else
+			out += c;
+	}
+}
+
+// thread_name metadata so viewers label the rows
+static void appendThreadName(std::string &out, int pid, int tid) {
+	char buf[128];
+	if (tid == 0)
+		std::snprintf(buf, sizeof(buf), "event loop");
+	else
+		std::snprintf(buf, sizeof(buf), "fd %d", tid);
+	std::string name(buf);
+	std::snprintf(buf, sizeof(buf),
+	              "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"",
+	              pid, tid);
+	out += buf;
+	out += name;
+	out += "\"}},\n";
+}
+
+// Complete events ("X") for spans; begin/end pairs ("b"/"e") keyed by fd for requests
+static void appendEvent(std::string &out, int pid, const char *name, const char *cat, int tid,
+                        bool async, long ts, long dur, const char *detail) {
+	char buf[160];
+	out += "{\"name\":\"";
+	out += name;
+	out += "\",\"cat\":\"";
+	out += cat;
+	if (async)
+		std::snprintf(buf, sizeof(buf), "\",\"ph\":\"b\",\"id\":%d,\"pid\":%d,\"tid\":%d,\"ts\":%ld",
+		              tid, pid, tid, ts);
+	else
+		std::snprintf(buf, sizeof(buf),
+		              "\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%ld,\"dur\":%ld", pid, tid, ts,
+		              dur);
+	out += buf;
+	if (*detail) {
+		out += ",\"args\":{\"detail\":\"";
+		appendJson(out, detail);
+		out += "\"}";
+	}
+	out += "},\n";
+	if (async) {
+		std::snprintf(buf, sizeof(buf),
+		              "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"e\",\"id\":%d,\"pid\":%d,\"tid\":%d,"
+		              "\"ts\":%ld},\n",
+		              name, cat, tid, pid, tid, ts + dur);
+		out += buf;
+	}
+}
+
+bool Tracer::dump(const std::string &path) {
+	_enabled = false;
+	int pid = getpid();
+	size_t kept = std::min(_count, _ring.size());
+	size_t first = (_next + _ring.size() - kept) % _ring.size();
+	std::set<int> tids;
+	std::string out;
+
+	out.reserve(kept * 160 + 64);
+	out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	for (size_t i = 0; i < kept; ++i) {
+		const Event &event = _ring[(first + i) % _ring.size()];
+		if (tids.insert(event.tid).second)
+			appendThreadName(out, pid, event.tid);
+		appendEvent(out, pid, event.name, event.cat, event.tid, event.async, event.ts, event.dur,
+		            event.detail);
+	}
+	if (kept)
+		out.erase(out.size() - 2, 1); // trailing comma
+	out += "]}\n";
+	std::vector<Event>().swap(_ring);
+
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+	if (!file)
+		return false;
+	file << out;
+	return file.good();
+}
@@ -0,0 +1,92 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Tracer.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:05:12 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 14:05:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include "includes/Webserv.hpp"
+
+/**
+ * Span recorder for profiling sessions, dumped in the Chrome trace event
+ * format (chrome://tracing, ui.perfetto.dev).
+ *
+ * Off by default and toggled at runtime (SIGPROF): while off, a span costs a
+ * flag check. While on, finished spans go into a ring of TRACE_EVENTS entries
+ * that overwrites the oldest ones, so a long session keeps its last moments.
+ *
+ * Spans are laid out like threads: the event loop is thread 0 and each client
+ * connection is its socket fd, so a handler blocking the loop shows as the
+ * same gap in every connection's timeline. Requests are drawn as async spans
+ * above the phases they contain.
+ */
+class Tracer {
+  public:
+	static bool enabled() { return _enabled; }
+	/// Clears the ring and starts recording.
+	static void start();
+	/// Stops recording and writes the ring to `path`.
+	/// \returns false if the file cannot be written.
+	static bool dump(const std::string &path);
+
+	/// Records a finished span. `name` and `cat` must be string literals.
+	static void record(const char *name, const char *cat, int tid, long begin_us, long end_us,
+	                   const std::string &detail = "");
+	/// Records a request, drawn on its own track for the connection.
+	static void request(int tid, long begin_us, long end_us, const std::string &detail);
+	static long now();
+
+  private:
+	struct Event {
+		const char *name;
+		const char *cat;
+		int tid;
+		bool async;
+		long ts;
+		long dur;
+		char detail[TRACE_DETAIL_SIZE];
+	};
+
+	static bool _enabled;
+	static std::vector<Event> _ring;
+	static size_t _next;  // slot of the next event
+	static size_t _count; // events recorded since start(), may exceed the ring
+
+	static Event &slot();
+};
+
+/// Records the enclosing scope as a span when tracing is on.
+class TraceSpan {
+  public:
+	TraceSpan(const char *name, const char *cat, int tid)
+	    : _name(name), _cat(cat), _tid(tid), _begin(Tracer::enabled() ? Tracer::now() : 0) {}
+	~TraceSpan() {
+		if (_begin)
+			Tracer::record(_name, _cat, _tid, _begin, Tracer::now(), _detail);
+	}
+	/// Attaches a detail (URI, path, count) shown with the span.
+	void detail(const std::string &detail) {
+		if (_begin)
+			_detail = detail;
+	}
+
+  private:
+	const char *_name;
+	const char *_cat;
+	int _tid;
+	long _begin;
+	std::string _detail;
+
+	TraceSpan(const TraceSpan &);
+	TraceSpan &operator=(const TraceSpan &);
+};
+
+#endif
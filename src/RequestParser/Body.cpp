@@ -28,7 +28,7 @@ uint16_t RequestParsingUtils::checkNTrimLine(std::string &line, Logger &logger)
 }
 
 uint16_t RequestParsingUtils::parseBody(std::istringstream &stream, ClientRequest &request, Logger &logger) {
-	logger.logWithPrefix(Logger::DEBUG, "HTTP", "Parsing message body");
+	LOG_DEBUG_P(logger, "HTTP", "Parsing message body");
 
 	const char *content_length_value = findHeader(request, "content-length", logger);
 
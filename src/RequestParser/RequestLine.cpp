@@ -123,7 +123,8 @@ uint16_t RequestParsingUtils::checkReqLine(ClientRequest &request, Logger &logge
 		return 400;
 	}
 
-	if (request.method != "POST" && request.method != "GET" && request.method != "DELETE") {
+	if (request.method != "POST" && request.method != "GET" && request.method != "PUT" &&
+	    request.method != "DELETE") {
 		logger.logWithPrefix(Logger::WARNING, "HTTP", "Unsupported HTTP method: " + request.method);
 		return 501;
 	}
@@ -168,7 +169,7 @@ uint16_t RequestParsingUtils::checkReqLine(ClientRequest &request, Logger &logge
 uint16_t RequestParsingUtils::parseReqLine(std::istringstream &stream, ClientRequest &request,
                                            Logger &logger) {
 	std::string line;
-	logger.logWithPrefix(Logger::DEBUG, "HTTP", "Parsing request line");
+	LOG_DEBUG_P(logger, "HTTP", "Parsing request line");
 
 	if (!std::getline(stream, line)) {
 		logger.logWithPrefix(Logger::WARNING, "HTTP", "No request line present");
@@ -96,7 +96,7 @@ std::string RequestParsingUtils::trimSide(const std::string &s, int type) {
 uint16_t RequestParsingUtils::parseTrailingHeaders(std::istringstream &stream,
                                                    ClientRequest &request, Logger &logger) {
 	std::string line;
-	logger.logWithPrefix(Logger::INFO, "HTTP", "Parsing trailing headers");
+	LOG_INFO_P(logger, "HTTP", "Parsing trailing headers");
 
 	while (std::getline(stream, line)) {
 		// Check if end of request
@@ -172,7 +172,7 @@ uint16_t RequestParsingUtils::parseRequest(const std::string &raw_request, Clien
 		return 400;
 	}
 
-	logger.logWithPrefix(Logger::DEBUG, "HTTP", "Parsing request");
+	LOG_DEBUG_P(logger, "HTTP", "Parsing request");
 	request.chunked_encoding = false;
 	request.file_upload = false;
 	request.extension = "";
@@ -205,7 +205,7 @@ uint16_t RequestParsingUtils::parseRequest(const std::string &raw_request, Clien
 	if (error_code != 0)
 		return error_code;
 
-	logger.logWithPrefix(Logger::INFO, "HTTP", "Request parsing completed");
+	LOG_INFO_P(logger, "HTTP", "Request parsing completed");
 	return 0;
 }
 
@@ -231,7 +231,7 @@ uint16_t RequestParsingUtils::parseRequestHeaders(const std::string &raw_request
 	if (error_code != 0)
 		return error_code;
 
-	logger.logWithPrefix(Logger::INFO, "HTTP", "Header Request parsing completed");
+	LOG_INFO_P(logger, "HTTP", "Header Request parsing completed");
 	return 0;
 }
 
@@ -37,4 +37,6 @@ uint16_t parseRequest(const std::string &raw_request, ClientRequest &request, Lo
 uint16_t parseRequestHeaders(const std::string &raw_request, ClientRequest &request, Logger &logger);
 } // namespace RequestParsingUtils
 
+bool decodeNValidateUri(const std::string &uri, std::string &decoded);
+
 #endif
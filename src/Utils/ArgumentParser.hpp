@@ -20,14 +20,24 @@ struct ServerArgs {
 	std::string prefix_path;
 	bool show_help;
 	bool show_version;
+	bool test_config; // parse and validate the configuration, then exit
 	int log_level; // 0=error, 1=warn, 2=info, 3=debug
+	int drain_timeout; // seconds, graceful shutdown and binary upgrade
+	bool log_drop;     // drop log lines instead of waiting when the log buffer is full
+	std::string trace_file; // written when tracing stops (SIGPROF)
+	int slow_event_ms;      // event handlers blocking the loop longer are logged, 0 never
 
 	ServerArgs()
 	    : config_file(""),
 	      prefix_path(""),
 	      show_help(false),
 	      show_version(false),
-	      log_level(1) {}
+	      test_config(false),
+	      log_level(1),
+	      drain_timeout(DRAIN_TIMEOUT),
+	      log_drop(false),
+	      trace_file(TRACE_FILE),
+	      slow_event_ms(SLOW_EVENT_MS) {}
 };
 
 class ArgumentParser {
@@ -43,6 +53,10 @@ class ArgumentParser {
 
 		known_flags.push_back("--prefix-path");
 		known_flags.push_back("--log-level");
+		known_flags.push_back("--drain-timeout");
+		known_flags.push_back("--log-overflow");
+		known_flags.push_back("--trace-file");
+		known_flags.push_back("--slow-event");
 	}
 
 	ServerArgs parseArgs(int argc, char *argv[]) {
@@ -58,6 +72,9 @@ class ArgumentParser {
 			} else if (arg == "--version" || arg == "-v") {
 				args.show_version = true;
 
+			} else if (arg == "--test-config" || arg == "-t") {
+				args.test_config = true;
+
 			} else if (arg == "--prefix-path") {
 				if (i + 1 < argc) {
 					args.prefix_path = argv[++i];
@@ -78,6 +95,46 @@ class ArgumentParser {
 			} else if (arg.find("--log-level=") == 0) {
 				args.log_level = parseLogLevel(arg.substr(12));
 
+			} else if (arg == "--drain-timeout") {
+				if (i + 1 < argc) {
+					args.drain_timeout = parseSeconds(argv[++i]);
+				} else {
+					throw std::runtime_error("--drain-timeout requires a value");
+				}
+
+			} else if (arg.find("--drain-timeout=") == 0) {
+				args.drain_timeout = parseSeconds(arg.substr(16));
+
+			} else if (arg == "--log-overflow") {
+				if (i + 1 < argc) {
+					args.log_drop = parseOverflow(argv[++i]);
+				} else {
+					throw std::runtime_error("--log-overflow requires a value");
+				}
+
+			} else if (arg.find("--log-overflow=") == 0) {
+				args.log_drop = parseOverflow(arg.substr(15));
+
+			} else if (arg == "--trace-file") {
+				if (i + 1 < argc) {
+					args.trace_file = argv[++i];
+				} else {
+					throw std::runtime_error("--trace-file requires a value");
+				}
+
+			} else if (arg.find("--trace-file=") == 0) {
+				args.trace_file = arg.substr(13);
+
+			} else if (arg == "--slow-event") {
+				if (i + 1 < argc) {
+					args.slow_event_ms = parseMilliseconds(argv[++i]);
+				} else {
+					throw std::runtime_error("--slow-event requires a value");
+				}
+
+			} else if (arg.find("--slow-event=") == 0) {
+				args.slow_event_ms = parseMilliseconds(arg.substr(13));
+
 			} else if (arg.find("--") == 0) {
 				throw std::runtime_error("Unknown option: " + arg);
 
@@ -101,8 +158,16 @@ class ArgumentParser {
 		std::cout << "Options:\n";
 		std::cout << "  -h, --help              Show this help message\n";
 		std::cout << "  -v, --version           Show version information\n";
+		std::cout << "  -t, --test-config       Check the configuration, report parse time and exit\n";
 		std::cout << "      --prefix-path PATH  Set prefix path for relative paths\n";
 		std::cout << "      --log-level LEVEL   Set log level (error|warn|info|debug)\n";
+		std::cout << "      --drain-timeout SEC Time given to in-flight requests on SIGQUIT/SIGTERM\n";
+		std::cout << "                          and SIGUSR2 (default " << DRAIN_TIMEOUT << ")\n";
+		std::cout << "      --log-overflow MODE When the log buffer is full: block (default) or drop\n";
+		std::cout << "      --trace-file PATH   Where SIGPROF writes the trace (default " << TRACE_FILE
+		          << ")\n";
+		std::cout << "      --slow-event MS     Log event handlers blocking the loop longer (default "
+		          << SLOW_EVENT_MS << ", 0 never)\n";
 		std::cout << "\nIf CONFIG_FILE is not specified, the following locations are tried:\n";
 
 		for (std::vector<std::string>::const_iterator it = default_config_paths.begin();
@@ -124,6 +189,9 @@ class ArgumentParser {
 			case 'v':
 				args.show_version = true;
 				break;
+			case 't':
+				args.test_config = true;
+				break;
 			default:
 				std::string unknown_opt = "-";
 				unknown_opt += opt;
@@ -131,6 +199,14 @@ class ArgumentParser {
 		}
 	}
 
+	bool parseOverflow(const std::string &mode) {
+		if (mode == "block")
+			return false;
+		if (mode == "drop")
+			return true;
+		throw std::runtime_error("Invalid log overflow mode: " + mode + " (use: block|drop)");
+	}
+
 	int parseLogLevel(const std::string &level) {
 		if (level == "error" || level == "0")
 			return 0;
@@ -145,6 +221,23 @@ class ArgumentParser {
 		                         " (use: error|warn|info|debug or 0-3)");
 	}
 
+	int parseSeconds(const std::string &value) {
+		std::istringstream ss(value);
+		int seconds;
+		if (!(ss >> seconds) || !ss.eof() || seconds < 0)
+			throw std::runtime_error("Invalid drain timeout: " + value + " (use seconds, >= 0)");
+		return seconds;
+	}
+
+	int parseMilliseconds(const std::string &value) {
+		std::istringstream ss(value);
+		int ms;
+		if (!(ss >> ms) || !ss.eof() || ms < 0)
+			throw std::runtime_error("Invalid slow event threshold: " + value +
+			                         " (use milliseconds, >= 0)");
+		return ms;
+	}
+
 	std::string determineConfigFile(const std::vector<std::string> &positional_args) {
 		// If user provided a positional argument, assume it's the config file
 		if (!positional_args.empty()) {
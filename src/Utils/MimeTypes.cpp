@@ -0,0 +1,214 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MimeTypes.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:24:07 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 11:24:07 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/Utils/MimeTypes.hpp"
+#include "src/Utils/StringUtils.hpp"
+
+namespace {
+
+struct BuiltinType {
+	const char *ext;
+	const char *type;
+};
+
+const BuiltinType builtinTypes[] = {
+    {"html", "text/html"},
+    {"htm", "text/html"},
+    {"shtml", "text/html"},
+    {"css", "text/css"},
+    {"xml", "text/xml"},
+    {"txt", "text/plain"},
+    {"csv", "text/csv"},
+    {"md", "text/markdown"},
+    {"ics", "text/calendar"},
+    {"js", "application/javascript"},
+    {"mjs", "application/javascript"},
+    {"json", "application/json"},
+    {"map", "application/json"},
+    {"webmanifest", "application/manifest+json"},
+    {"wasm", "application/wasm"},
+    {"pdf", "application/pdf"},
+    {"rtf", "application/rtf"},
+    {"zip", "application/zip"},
+    {"gz", "application/gzip"},
+    {"tgz", "application/gzip"},
+    {"tar", "application/x-tar"},
+    {"bz2", "application/x-bzip2"},
+    {"xz", "application/x-xz"},
+    {"7z", "application/x-7z-compressed"},
+    {"rar", "application/vnd.rar"},
+    {"jar", "application/java-archive"},
+    {"bin", "application/octet-stream"},
+    {"exe", "application/octet-stream"},
+    {"iso", "application/octet-stream"},
+    {"doc", "application/msword"},
+    {"docx", "application/vnd.openxmlformats-officedocument.wordprocessingml.document"},
+    {"xls", "application/vnd.ms-excel"},
+    {"xlsx", "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"},
+    {"ppt", "application/vnd.ms-powerpoint"},
+    {"pptx", "application/vnd.openxmlformats-officedocument.presentationml.presentation"},
+    {"odt", "application/vnd.oasis.opendocument.text"},
+    {"epub", "application/epub+zip"},
+    {"atom", "application/atom+xml"},
+    {"rss", "application/rss+xml"},
+    {"xhtml", "application/xhtml+xml"},
+    {"php", "application/x-httpd-php"},
+    {"py", "text/x-python"},
+    {"sh", "application/x-sh"},
+    {"png", "image/png"},
+    {"jpg", "image/jpeg"},
+    {"jpeg", "image/jpeg"},
+    {"gif", "image/gif"},
+    {"svg", "image/svg+xml"},
+    {"svgz", "image/svg+xml"},
+    {"ico", "image/x-icon"},
+    {"webp", "image/webp"},
+    {"avif", "image/avif"},
+    {"bmp", "image/bmp"},
+    {"tif", "image/tiff"},
+    {"tiff", "image/tiff"},
+    {"woff", "font/woff"},
+    {"woff2", "font/woff2"},
+    {"ttf", "font/ttf"},
+    {"otf", "font/otf"},
+    {"eot", "application/vnd.ms-fontobject"},
+    {"mp3", "audio/mpeg"},
+    {"ogg", "audio/ogg"},
+    {"oga", "audio/ogg"},
+    {"wav", "audio/wav"},
+    {"flac", "audio/flac"},
+    {"m4a", "audio/mp4"},
+    {"aac", "audio/aac"},
+    {"mid", "audio/midi"},
+    {"midi", "audio/midi"},
+    {"mp4", "video/mp4"},
+    {"m4v", "video/mp4"},
+    {"webm", "video/webm"},
+    {"ogv", "video/ogg"},
+    {"mov", "video/quicktime"},
+    {"avi", "video/x-msvideo"},
+    {"mkv", "video/x-matroska"},
+    {"mpeg", "video/mpeg"},
+    {"mpg", "video/mpeg"},
+    {"ts", "video/mp2t"},
+    {"3gp", "video/3gpp"},
+};
+
+// Case-insensitive ordering; table keys are stored lowercase
+int compareExt(const std::string &key, const char *ext, size_t len) {
+	size_t n = std::min(key.size(), len);
+	for (size_t i = 0; i < n; ++i) {
+		int c = std::tolower(static_cast<unsigned char>(ext[i]));
+		if (key[i] != c)
+			return static_cast<unsigned char>(key[i]) < c ? -1 : 1;
+	}
+	if (key.size() == len)
+		return 0;
+	return key.size() < len ? -1 : 1;
+}
+
+} // namespace
+
+MimeTypes::MimeTypes()
+    : _added(0) {
+	reset();
+}
+
+const MimeTypes &MimeTypes::builtin() {
+	static const MimeTypes table;
+	return table;
+}
+
+void MimeTypes::reset() {
+	_table.clear();
+	_added = 0;
+	for (size_t i = 0; i < sizeof(builtinTypes) / sizeof(builtinTypes[0]); ++i)
+		add(builtinTypes[i].ext, builtinTypes[i].type);
+	build();
+}
+
+bool MimeTypes::Entry::operator<(const Entry &other) const {
+	if (ext != other.ext)
+		return ext < other.ext;
+	return rank < other.rank;
+}
+
+void MimeTypes::add(const std::string &ext, const std::string &type) {
+	Entry entry;
+	entry.ext = su::to_lower((!ext.empty() && ext[0] == '.') ? ext.substr(1) : ext);
+	if (entry.ext.empty())
+		return;
+	entry.type = type;
+	entry.rank = _added++;
+	_table.push_back(entry);
+}
+
+bool MimeTypes::loadFile(const std::string &path) {
+	std::ifstream file(path.c_str());
+	if (!file.is_open())
+		return false;
+
+	std::string line;
+	while (std::getline(file, line)) {
+		line = line.substr(0, line.find('#'));
+		if (line.find('{') != std::string::npos || line.find('}') != std::string::npos)
+			continue; // nginx "types {" wrapper
+		std::replace(line.begin(), line.end(), ';', ' ');
+		std::istringstream iss(line);
+		std::string type;
+		std::string ext;
+		if (!(iss >> type) || type.find('/') == std::string::npos)
+			continue;
+		while (iss >> ext)
+			add(ext, type);
+	}
+	return true;
+}
+
+void MimeTypes::build() {
+	std::sort(_table.begin(), _table.end());
+	std::vector<Entry> unique;
+	unique.reserve(_table.size());
+	for (size_t i = 0; i < _table.size(); ++i) {
+		// sorted by extension then rank: the last of a run is the latest definition
+		if (i + 1 < _table.size() && _table[i + 1].ext == _table[i].ext)
+			continue;
+		unique.push_back(_table[i]);
+	}
+	_table.swap(unique);
+}
+
+const std::string *MimeTypes::find(const std::string &ext) const {
+	return find(ext.data(), ext.size());
+}
+
+const std::string *MimeTypes::find(const char *key, size_t len) const {
+	if (len > 0 && key[0] == '.') {
+		++key;
+		--len;
+	}
+	size_t lo = 0;
+	size_t hi = _table.size();
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		int cmp = compareExt(_table[mid].ext, key, len);
+		if (cmp == 0)
+			return &_table[mid].type;
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return NULL;
+}
+
+size_t MimeTypes::size() const { return _table.size(); }
@@ -0,0 +1,63 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MimeTypes.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:24:07 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 11:24:07 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MIMETYPES_HPP
+#define MIMETYPES_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Extension -> MIME type table.
+///
+/// Seeded with a built-in table, extended at config load by `types {}` blocks
+/// and `types_file`, then frozen into a sorted flat table searched with a
+/// binary search (no allocation per lookup). Each ConfigSnapshot owns the
+/// table of its configuration, so a reload doesn't change the types served
+/// to connections still on the previous one.
+class MimeTypes {
+  public:
+	/// A table holding the built-in types.
+	MimeTypes();
+
+	/// \returns The built-in table, for code without a configuration.
+	static const MimeTypes &builtin();
+
+	/// Drops configured entries and goes back to the built-in table.
+	void reset();
+	/// Registers (or overrides) an extension, without the leading dot.
+	void add(const std::string &ext, const std::string &type);
+	/// Loads a mime.types file ("type ext1 ext2", optionally nginx style).
+	/// \returns False if the file cannot be read.
+	bool loadFile(const std::string &path);
+	/// Sorts the table and removes overridden duplicates. Call once entries are in.
+	void build();
+
+	/// \param ext Extension with or without the leading dot, any case.
+	/// \returns The MIME type, or NULL if the extension is unknown.
+	const std::string *find(const std::string &ext) const;
+	/// Same, for an extension that is a slice of a longer string.
+	const std::string *find(const char *ext, size_t len) const;
+	size_t size() const;
+
+  private:
+	struct Entry {
+		std::string ext;
+		std::string type;
+		size_t rank; // insertion order, the latest definition wins in build()
+
+		bool operator<(const Entry &other) const;
+	};
+
+	std::vector<Entry> _table;
+	size_t _added;
+};
+
+#endif /* end of include guard: MIMETYPES_HPP */
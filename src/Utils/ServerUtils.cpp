@@ -11,6 +11,7 @@
 /* ************************************************************************** */
 
 #include "src/Utils/ServerUtils.hpp"
+#include "src/Utils/MimeTypes.hpp"
 
 time_t WebServer::getCurrentTime() const { return time(NULL); }
 
@@ -27,7 +28,7 @@ std::string WebServer::getFileContent(std::string path) {
 		buffer << file.rdbuf();
 		file.close();
 		content = buffer.str();
-		_lggr.logWithPrefix(Logger::DEBUG, "File Handling",
+		LOG_DEBUG_P(_lggr, "File Handling",
 							"Read " + su::to_string(content.size()) + " bytes from " + path);
 	}
 	return content;
@@ -73,7 +74,24 @@ std::string fileTypeToString(FileType type) {
 	}
 }
 
-std::string WebServer::buildFullPath(const std::string &uri, LocConfig *location) {
+// IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+std::string httpDate(time_t t) {
+	struct tm tm_buf;
+	char buffer[64];
+
+	gmtime_r(&t, &tm_buf);
+	strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm_buf);
+	return std::string(buffer);
+}
+
+// Strong validator built from inode, size and modification time
+std::string makeETag(const struct stat &st) {
+	std::ostringstream oss;
+	oss << "\"" << std::hex << st.st_ino << "-" << st.st_size << "-" << st.st_mtime << "\"";
+	return oss.str();
+}
+
+std::string WebServer::buildFullPath(const std::string &uri, const LocConfig *location) {
 
 	std::string root = location->root;
 	root = (su::back(root) == '/') ? root : root + "/";
@@ -101,64 +119,53 @@ std::string getExtension(const std::string &path) {
 	return "";
 }
 
-std::string detectContentType(const std::string &path) {
-
-	std::map<std::string, std::string> cTypes;
-	cTypes[".css"] = "text/css";
-	cTypes[".js"] = "application/javascript";
-	cTypes[".html"] = "text/html";
-	cTypes[".htm"] = "text/html";
-	cTypes[".json"] = "application/json";
-	cTypes[".png"] = "image/png";
-	cTypes[".jpg"] = "image/jpeg";
-	cTypes[".jpeg"] = "image/jpeg";
-	cTypes[".gif"] = "image/gif";
-	cTypes[".svg"] = "image/svg+xml";
-	cTypes[".ico"] = "image/x-icon";
-	cTypes[".txt"] = "text/plain";
-	cTypes[".pdf"] = "application/pdf";
-	cTypes[".zip"] = "application/zip";
-
-	std::string ext = getExtension(path);
-	std::map<std::string, std::string>::const_iterator it = cTypes.find(ext);
-	if (it != cTypes.end())
-		return it->second;
-	return "application/octet-stream";
+std::string detectContentType(const MimeTypes &types, const std::string &path,
+                              const std::string &fallback) {
+	// getExtension() without the copy: the extension is looked up in place
+	std::size_t end = path.find('?');
+	if (end == std::string::npos)
+		end = path.size();
+	std::size_t dot = path.find_last_of('.', end);
+	if (dot == std::string::npos)
+		return fallback;
+	const std::string *type = types.find(path.data() + dot, end - dot);
+	return type ? *type : fallback;
 }
 
-LocConfig *findBestMatch(const std::string &uri, std::vector<LocConfig> &locations, Logger& logger) {
-	for (std::vector<LocConfig>::iterator it = locations.begin(); it != locations.end(); ++it) {
-		if (isPrefixMatch(uri, *it, logger)) {
-			return &(*it);
+// Accept-Encoding negotiation: gzip (or x-gzip) wins over '*', and a
+// q-value of 0 means "not acceptable"
+bool acceptsGzip(const ClientRequest &req) {
+	std::map<std::string, std::string>::const_iterator it = req.headers.find("accept-encoding");
+	if (it == req.headers.end())
+		return false;
+
+	double gzip_q = -1;
+	double any_q = -1;
+	std::vector<std::string> codings = su::split(it->second, ',');
+	for (size_t i = 0; i < codings.size(); ++i) {
+		std::vector<std::string> params = su::split(codings[i], ';');
+		if (params.empty())
+			continue;
+		std::string coding = su::to_lower(su::trim(params[0]));
+		double q = 1;
+		for (size_t j = 1; j < params.size(); ++j) {
+			std::string param = su::to_lower(su::trim(params[j]));
+			if (su::starts_with(param, "q="))
+				q = std::strtod(param.c_str() + 2, NULL);
 		}
+		if (coding == "gzip" || coding == "x-gzip")
+			gzip_q = q;
+		else if (coding == "*")
+			any_q = q;
 	}
-	return NULL;
+	if (gzip_q >= 0)
+		return gzip_q > 0;
+	return any_q > 0;
 }
 
-bool isPrefixMatch(const std::string &uri, LocConfig &loc, Logger& log) {
-
-	std::string location_path = loc.getPath();
-
-	// reached only at last since the locconfig are sorted -> no better match 
-	if (location_path.empty() || location_path == "/") { 
-		return true;
-	}
-	if (uri.length() < location_path.length()) {
-		return false;
-	}
-	// Check for prefix
-	if (uri.substr(0, location_path.length()) != location_path) {
-		return false;
-	}
-	if (uri.length() == location_path.length()) {
-		log.debug(" uri : " + uri + " loc : " + location_path);
-		return true; // Exact match
-	}
-	if (loc.is_exact_()) {
-		return false;
-	}
-	// Next character should be '/' or end of string
-	char next_char = uri[location_path.length()];
-	return next_char == '/' || location_path[location_path.length() - 1] == '/';
+// Monotonic clock in microseconds, for durations: unaffected by clock changes
+long monotonicUs() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000L + now.tv_nsec / 1000;
 }
-
@@ -19,13 +19,20 @@
 #include "src/HttpServer/Structs/Connection.hpp"
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/HttpServer/HttpServer.hpp"
+#include "src/Utils/MimeTypes.hpp"
 
 std::string getExtensionForMime(const std::string &path);
 std::string detectContentTypeLocal(const std::string &path);
 std::string getExtension(const std::string &path);
-std::string detectContentType(const std::string &path);
-bool isPrefixMatch(const std::string &uri, LocConfig &loc, Logger &log);
-LocConfig *findBestMatch(const std::string &uri, std::vector<LocConfig> &locations, Logger &log);
+std::string detectContentType(const MimeTypes &types, const std::string &path,
+                              const std::string &fallback = "application/octet-stream");
 std::string fileTypeToString(FileType type);
+std::string httpDate(time_t t);
+std::string makeETag(const struct stat &st);
+RangeStatus parseByteRanges(const std::string &header, off_t size,
+                            std::vector<std::pair<off_t, off_t> > &ranges);
+bool ifRangeMatches(const ClientRequest &req, const struct stat &st);
+bool acceptsGzip(const ClientRequest &req);
+long monotonicUs();
 
 #endif
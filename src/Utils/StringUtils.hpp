@@ -186,6 +186,18 @@ inline std::string replace_all(const std::string &str, const std::string &from,
 	return result;
 }
 
+/**
+ * FNV-1a hash of a string
+ */
+inline size_t hash(const std::string &str) {
+	size_t h = 2166136261u;
+	for (size_t i = 0; i < str.size(); ++i) {
+		h ^= static_cast<unsigned char>(str[i]);
+		h *= 16777619u;
+	}
+	return h;
+}
+
 /**
  * Check if string contains only whitespace characters
  */
@@ -0,0 +1,103 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   main.cpp                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 15:20:11 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 15:20:11 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/ConfigParser/ConfigParser.hpp"
+#include "src/HttpServer/HttpServer.hpp"
+#include "src/HttpServer/Structs/WebServer.hpp"
+#include "src/Utils/ArgumentParser.hpp"
+
+static std::string getCurrentWorkingDirectory() {
+	char cwd[PATH_MAX];
+	if (getcwd(cwd, sizeof(cwd)) == NULL) {
+		std::cerr << "Warning: could not resolve current working directory." << std::endl;
+		return "";
+	}
+	std::string dir(cwd);
+	return dir;
+}
+
+int main(int argc, char *argv[]) {
+	ArgumentParser ap;
+	ServerArgs args;
+
+	try {
+		args = ap.parseArgs(argc, argv);
+		if (args.show_help) {
+			ap.printUsage(argv[0]);
+			return 0;
+		}
+		if (args.show_version) {
+			std::cout << __WEBSERV_VERSION__ << std::endl;
+			return 0;
+		}
+		if (args.prefix_path.empty()) {
+			args.prefix_path = getCurrentWorkingDirectory();
+		}
+		std::cout << "prefix_path: " << args.prefix_path << std::endl;
+	} catch (const std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		std::cerr << "Use --help for usage information." << std::endl;
+		return 1;
+	}
+
+	if (args.log_drop)
+		Logger::setOverflowPolicy(LogWriter::DROP);
+
+	ConfigParser configparser(args.log_level);
+	std::vector<ServerConfig> servers;
+	MimeTypes types;
+
+	if (args.test_config) {
+		struct timeval start, end;
+		gettimeofday(&start, NULL);
+		bool ok = configparser.loadConfig(args.config_file, servers, types, args.prefix_path,
+		                                  args.log_level);
+		gettimeofday(&end, NULL);
+		long ms = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_usec - start.tv_usec) / 1000;
+		if (!ok) {
+			std::cerr << "configuration file " << args.config_file << " test failed in " << ms
+			          << " ms (see Config.log)" << std::endl;
+			return 1;
+		}
+		size_t locations = 0;
+		for (size_t i = 0; i < servers.size(); ++i)
+			locations += servers[i].getLocations().size();
+		std::cout << "configuration file " << args.config_file << " test is successful: "
+		          << servers.size() << " server(s), " << locations << " location(s), parsed in "
+		          << ms << " ms" << std::endl;
+		return 0;
+	}
+
+	if (!configparser.loadConfig(args.config_file, servers, types, args.prefix_path,
+	                             args.log_level)) {
+		std::cerr << "Error: Failed to open or parse configuration file '" << args.config_file
+		          << "'" << std::endl;
+		std::cerr << "Please check the configuration file syntax and try again." << std::endl;
+		return 1;
+	}
+
+	WebServer webserv(servers, types, args.prefix_path, args.log_level);
+
+    webserv.log_level = args.log_level;
+	webserv.config_file = args.config_file;
+	webserv.exec_argv.assign(argv, argv + argc);
+	webserv.drain_timeout = args.drain_timeout;
+	webserv.trace_file = args.trace_file;
+	webserv.slow_event_ms = args.slow_event_ms;
+	if (!webserv.initialize()) {
+		std::cerr << "Failed to initialize web server." << std::endl;
+		return 1;
+	}
+
+	webserv.run();
+	return 0;
+}
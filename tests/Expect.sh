@@ -0,0 +1,38 @@
+#!/bin/bash
+# Expect: 100-continue checks against config_example/basic.conf (servers on 8080 and 8081)
+
+HOST=127.0.0.1
+URL="http://$HOST:8080/images/"
+SMALL="http://$HOST:8081/method/" # client_max_body_size 10k
+TMP=$(mktemp -d)
+
+source "$(dirname "$0")/lib.sh"
+
+# interim 100 responses seen by curl
+continues() {
+  curl -sv -o /dev/null "$@" 2>&1 | grep -c '^< HTTP/1.1 100'
+}
+
+mkdir -p www/uploads
+head -c 200000 /dev/urandom > $TMP/a.bin
+NAME="expect-test-$$"
+
+echo -e "${YELLOW}========== EXPECT TESTS ==========${NC}"
+
+check "Accepted -> 100 Continue" "1" \
+      "$(continues -H 'Expect: 100-continue' -T $TMP/a.bin "$URL$NAME.bin")"
+check "Then the body is taken" "$(md5sum < $TMP/a.bin)" "$(md5sum < www/uploads/$NAME.bin)"
+check "Too large -> 413" "413" \
+      "$(status -H 'Expect: 100-continue' --data-binary @$TMP/a.bin "$SMALL")"
+check "No 100 before the 413" "0" \
+      "$(continues -H 'Expect: 100-continue' --data-binary @$TMP/a.bin "$SMALL")"
+check "Method not allowed -> 405" "405" \
+      "$(status -H 'Expect: 100-continue' --data-binary @$TMP/a.bin "http://$HOST:8080/")"
+check "No 100 before the 405" "0" \
+      "$(continues -H 'Expect: 100-continue' --data-binary @$TMP/a.bin "http://$HOST:8080/")"
+check "Unknown expectation -> 417" "417" \
+      "$(status -H 'Expect: something-else' --data-binary @$TMP/a.bin "$URL")"
+
+rm -rf $TMP www/uploads/$NAME*
+
+finish
@@ -0,0 +1,39 @@
+#!/bin/bash
+# gzip / gzip_static checks against config_example/basic.conf (server on 8080)
+
+HOST=127.0.0.1
+PORT=8080
+FILE=www/styles.css
+URL="http://$HOST:$PORT/styles.css"
+
+source "$(dirname "$0")/lib.sh"
+
+echo -e "${YELLOW}========== GZIP TESTS ==========${NC}"
+
+check "No Accept-Encoding -> identity" "" "$(header Content-Encoding "$URL")"
+check "Accept-Encoding: gzip -> gzip" "gzip" \
+      "$(header Content-Encoding -H 'Accept-Encoding: gzip' "$URL")"
+check "gzip;q=0 -> identity" "" \
+      "$(header Content-Encoding -H 'Accept-Encoding: gzip;q=0, deflate' "$URL")"
+check "Wildcard -> gzip" "gzip" "$(header Content-Encoding -H 'Accept-Encoding: *' "$URL")"
+check "Streamed file is chunked" "chunked" \
+      "$(header Transfer-Encoding -H 'Accept-Encoding: gzip' "$URL")"
+check "Vary header" "Accept-Encoding" "$(header Vary "$URL")"
+check "Decoded body" "$(md5sum < $FILE)" \
+      "$(curl -s -H 'Accept-Encoding: gzip' "$URL" | gunzip -c | md5sum)"
+check "Directory listing compressed" "gzip" \
+      "$(header Content-Encoding -H 'Accept-Encoding: gzip' "http://$HOST:$PORT/error/")"
+check "Image not compressed" "" \
+      "$(header Content-Encoding -H 'Accept-Encoding: gzip' "http://$HOST:$PORT/favicon.png")"
+
+echo -e "${YELLOW}========== GZIP_STATIC TESTS ==========${NC}"
+
+gzip -k -9 -f $FILE
+check "Precompressed sibling served" "$(md5sum < $FILE.gz)" \
+      "$(curl -s -H 'Accept-Encoding: gzip' "$URL" | md5sum)"
+check "Precompressed has Content-Length" "$(stat -c %s $FILE.gz)" \
+      "$(header Content-Length -H 'Accept-Encoding: gzip' "$URL")"
+check "Identity client gets original" "$(md5sum < $FILE)" "$(curl -s "$URL" | md5sum)"
+rm -f $FILE.gz
+
+finish
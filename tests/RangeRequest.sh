@@ -0,0 +1,30 @@
+#!/bin/bash
+# Range / If-Range checks against config_example/basic.conf (server on 8081)
+
+HOST=127.0.0.1
+PORT=8081
+FILE=www2/cats/cat1.jpg
+URL="http://$HOST:$PORT/cats/cat1.jpg"
+
+source "$(dirname "$0")/lib.sh"
+
+echo -e "${YELLOW}========== RANGE REQUEST TESTS ==========${NC}"
+
+check "No Range -> 200" "200" "$(status "$URL")"
+check "Single range -> 206" "206" "$(status -H 'Range: bytes=0-99' "$URL")"
+check "Single range body" "$(head -c 100 $FILE | md5sum)" \
+      "$(curl -s -H 'Range: bytes=0-99' "$URL" | md5sum)"
+check "Suffix range body" "$(tail -c 512 $FILE | md5sum)" \
+      "$(curl -s -H 'Range: bytes=-512' "$URL" | md5sum)"
+check "Open-ended range body" "$(tail -c +1001 $FILE | md5sum)" \
+      "$(curl -s -H 'Range: bytes=1000-' "$URL" | md5sum)"
+check "Multiple ranges -> multipart" "multipart/byteranges" \
+      "$(curl -s -o /dev/null -w '%{content_type}' -H 'Range: bytes=0-9,100-109' "$URL" | cut -d';' -f1)"
+check "Unsatisfiable range -> 416" "416" "$(status -H 'Range: bytes=999999999-' "$URL")"
+check "Malformed range ignored -> 200" "200" "$(status -H 'Range: bytes=abc' "$URL")"
+
+ETAG=$(curl -s -D - -o /dev/null "$URL" | grep -i '^etag:' | cut -d' ' -f2 | tr -d '\r')
+check "If-Range matching ETag -> 206" "206" "$(status -H 'Range: bytes=0-9' -H "If-Range: $ETAG" "$URL")"
+check "If-Range stale ETag -> 200" "200" "$(status -H 'Range: bytes=0-9' -H 'If-Range: "stale"' "$URL")"
+
+finish
@@ -0,0 +1,58 @@
+#!/bin/bash
+# upload on checks against config_example/basic.conf (server on 8080, /images/ -> www/uploads)
+
+HOST=127.0.0.1
+PORT=8080
+DIR=www/uploads
+URL="http://$HOST:$PORT/images/"
+TMP=$(mktemp -d)
+
+source "$(dirname "$0")/lib.sh"
+
+mkdir -p $DIR
+head -c 300000 /dev/urandom > $TMP/a.bin
+printf 'hello\n' > $TMP/b.txt
+NAME="upload-test-$$"
+
+echo -e "${YELLOW}========== UPLOAD TESTS ==========${NC}"
+
+check "Single file -> 201" "201" "$(status -F "file=@$TMP/a.bin;filename=$NAME.bin" "$URL")"
+check "Saved content" "$(md5sum < $TMP/a.bin)" "$(md5sum < $DIR/$NAME.bin)"
+check "Same name kept apart" "201" "$(status -F "file=@$TMP/b.txt;filename=$NAME.bin" "$URL")"
+check "Second file renamed" "$(md5sum < $TMP/b.txt)" "$(md5sum < "$DIR/$NAME(1).bin")"
+check "Chunked body -> 201" "201" \
+      "$(status -H 'Transfer-Encoding: chunked' -F "f=@$TMP/a.bin;filename=$NAME-c.bin" "$URL")"
+check "Chunked content" "$(md5sum < $TMP/a.bin)" "$(md5sum < $DIR/$NAME-c.bin)"
+check "Several files" "201" \
+      "$(status -F "x=1" -F "a=@$TMP/a.bin;filename=$NAME-1.bin" \
+                -F "b=@$TMP/b.txt;filename=$NAME-2.txt" "$URL")"
+check "Both saved" "2" "$(ls $DIR/$NAME-1.bin $DIR/$NAME-2.txt 2>/dev/null | wc -l)"
+check "Path stripped from name" "201" \
+      "$(status -F "file=@$TMP/b.txt;filename=../../$NAME-evil.txt" "$URL")"
+check "Saved inside upload_path" "1" "$(ls $DIR/$NAME-evil.txt 2>/dev/null | wc -l)"
+check "Fields only -> 400" "400" "$(status -F "x=1" "$URL")"
+check "Missing boundary -> 400" "400" \
+      "$(status -H 'Content-Type: multipart/form-data' --data-binary @$TMP/b.txt "$URL")"
+check "No temporary file left" "0" "$(ls -A $DIR | grep -c '^\.upload-')"
+check "CGI still gets the body" "201" \
+      "$(status -F "file=@$TMP/b.txt;filename=$NAME-cgi.txt" "http://$HOST:$PORT/cgi-bin/py/upload.py")"
+
+echo -e "${YELLOW}========== PUT / DELETE TESTS ==========${NC}"
+
+check "PUT new file -> 201" "201" "$(status -T $TMP/a.bin "$URL$NAME-put.bin")"
+check "PUT content" "$(md5sum < $TMP/a.bin)" "$(md5sum < $DIR/$NAME-put.bin)"
+check "PUT replace -> 204" "204" "$(status -T $TMP/b.txt "$URL$NAME-put.bin")"
+check "Replaced content" "$(md5sum < $TMP/b.txt)" "$(md5sum < $DIR/$NAME-put.bin)"
+check "PUT chunked -> 201" "201" \
+      "$(status -T $TMP/a.bin -H 'Transfer-Encoding: chunked' "$URL$NAME-putc.bin")"
+check "PUT chunked content" "$(md5sum < $TMP/a.bin)" "$(md5sum < $DIR/$NAME-putc.bin)"
+check "PUT missing directory -> 409" "409" "$(status -T $TMP/b.txt "${URL}nodir/$NAME.bin")"
+check "PUT without upload on -> 405" "405" "$(status -T $TMP/b.txt "http://$HOST:$PORT/$NAME.bin")"
+check "DELETE -> 204" "204" "$(status -X DELETE "$URL$NAME-put.bin")"
+check "File removed" "0" "$(ls $DIR/$NAME-put.bin 2>/dev/null | wc -l)"
+check "DELETE again -> 404" "404" "$(status -X DELETE "$URL$NAME-put.bin")"
+check "No temporary file left" "0" "$(ls -A $DIR | grep -c '^\.put-')"
+
+rm -rf $TMP $DIR/$NAME*
+
+finish
@@ -0,0 +1,71 @@
+#!/bin/bash
+# Benchmark scenarios against tests/conf/base1.conf, one JSON line per scenario.
+# Run from the repository root (make bench). Build with `make release` first
+# for numbers worth comparing. A scenario getting other statuses than it
+# expects, connection errors or timeouts is reported as failed on stderr and
+# makes the script exit with 1: its numbers don't measure what they claim.
+#
+#   DURATION     measured seconds per scenario (default 10)
+#   WARMUP       unmeasured seconds before each scenario (default 1)
+#   CONNECTIONS  concurrent connections (default 32)
+#   SCENARIOS    space separated subset of the scenarios below (default all)
+
+DURATION=${DURATION:-10}
+WARMUP=${WARMUP:-1}
+CONNECTIONS=${CONNECTIONS:-32}
+SCENARIOS=${SCENARIOS:-"static_keepalive static_close static_pipeline static_mix vhost cgi_get upload_length upload_chunked"}
+
+LOADGEN=./tests/bench/loadgen
+SERVER=./webserv
+
+if [ ! -x "$LOADGEN" ] || [ ! -x "$SERVER" ]; then
+  echo "bench.sh: build webserv and $LOADGEN first (make bench)" >&2
+  exit 1
+fi
+
+$SERVER --log-level=error --prefix-path="$PWD/tests/conf/html" tests/conf/base1.conf > /dev/null 2>&1 &
+SERVER_PID=$!
+trap 'kill $SERVER_PID 2>/dev/null; wait $SERVER_PID 2>/dev/null' EXIT
+
+# Wait for the three listeners
+for _ in $(seq 50); do
+  curl -s -o /dev/null http://127.0.0.1:8082/ && break
+  sleep 0.1
+done
+
+FAILED=""
+
+run() {
+  local name="$1"
+  shift
+  case " $SCENARIOS " in
+    *" $name "*) ;;
+    *) return ;;
+  esac
+  $LOADGEN -n "$name" -d "$DURATION" -w "$WARMUP" "$@"
+  local status=$?
+  if [ $status -eq 3 ]; then
+    echo "bench.sh: $name FAILED: unexpected statuses, errors or timeouts (see its line)" >&2
+    FAILED="$FAILED $name"
+  elif [ $status -ne 0 ]; then
+    echo "bench.sh: $name FAILED: loadgen exited with $status" >&2
+    FAILED="$FAILED $name"
+  fi
+}
+
+echo "{\"commit\":\"$(git rev-parse --short HEAD 2>/dev/null)\",\"date\":\"$(date -u +%Y-%m-%dT%H:%M:%SZ)\",\"duration_s\":$DURATION,\"connections\":$CONNECTIONS}"
+
+run static_keepalive -c "$CONNECTIONS" -r "GET /"
+run static_close -c "$CONNECTIONS" -C -r "GET /"
+run static_pipeline -c "$CONNECTIONS" -P 8 -r "GET /"
+run static_mix -c "$CONNECTIONS" \
+  -r "GET / weight=6" -r "GET /favicon.ico weight=2" -r "GET /favicon.png" -r "GET /missing status=404"
+run vhost -c "$CONNECTIONS" -p 8082 -r "GET /"
+run cgi_get -c 4 -r "GET /cgi-bin/echo.py?x=1"
+run upload_length -c 4 -r "POST /cgi-bin/echo.py body=65536"
+run upload_chunked -c 4 -r "POST /cgi-bin/echo.py body=65536 chunk=1024"
+
+if [ -n "$FAILED" ]; then
+  echo "bench.sh: failed scenarios:$FAILED" >&2
+  exit 1
+fi
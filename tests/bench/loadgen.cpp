@@ -0,0 +1,562 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   loadgen.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:48:30 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 14:48:30 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// HTTP/1.1 load generator for webserv benchmarks.
+//
+// One thread, one epoll loop, `connections` sockets each keeping up to
+// `pipeline` requests in flight. Requests come from a weighted mix, picked in
+// a fixed order so two runs send the same sequence. Latency is measured from
+// the moment a request is queued to the last byte of its response, and every
+// sample is kept, so percentiles are exact. Results are printed as one JSON
+// object. A response other than the request's expected status (any 2xx/3xx
+// by default), a connection error or a timeout makes the exit status 3.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+struct RequestSpec {
+	std::string method;
+	std::string path;
+	size_t body;  // bytes of body, 0 for none
+	size_t chunk; // chunked upload in pieces of this size, 0 for Content-Length
+	unsigned weight;
+	int status;       // expected response status, 0 for any 2xx or 3xx
+	std::string wire; // serialized once, sent as is
+};
+
+struct Options {
+	std::string name;
+	std::string host;
+	int port;
+	int connections;
+	int pipeline;
+	double duration;
+	double warmup;
+	double timeout;
+	bool keepalive;
+	std::vector<RequestSpec> mix;
+
+	Options()
+	    : name("bench"),
+	      host("127.0.0.1"),
+	      port(8080),
+	      connections(32),
+	      pipeline(1),
+	      duration(10),
+	      warmup(1),
+	      timeout(5),
+	      keepalive(true) {}
+};
+
+struct InFlight {
+	long queued;
+	bool head;
+	int expect; // RequestSpec::status
+};
+
+struct Client {
+	int fd;
+	bool connected;
+	std::string out;
+	size_t out_off;
+	std::string in;
+	size_t in_off;
+	std::deque<InFlight> inflight;
+	long last_progress;
+
+	Client() : fd(-1), connected(false), out_off(0), in_off(0), last_progress(0) {}
+};
+
+struct Stats {
+	std::vector<long> latencies;
+	unsigned long status[6]; // unparsable, 1xx .. 5xx
+	unsigned long unexpected; // responses other than the expected status
+	unsigned long errors;
+	unsigned long timeouts;
+	unsigned long connects;
+	unsigned long bytes_in;
+	unsigned long bytes_out;
+
+	Stats() : unexpected(0), errors(0), timeouts(0), connects(0), bytes_in(0), bytes_out(0) {
+		std::fill(status, status + 6, 0UL);
+	}
+};
+
+static long nowUs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+static std::string toString(unsigned long n) {
+	std::ostringstream out;
+	out << n;
+	return out.str();
+}
+
+static void usage(const char *prog) {
+	std::fprintf(stderr,
+	             "Usage: %s [options] -r REQUEST [-r REQUEST ...]\n"
+	             "  -n NAME      scenario name in the report (default bench)\n"
+	             "  -H HOST      server address (default 127.0.0.1)\n"
+	             "  -p PORT      server port (default 8080)\n"
+	             "  -c N         connections (default 32)\n"
+	             "  -P N         requests in flight per connection (default 1)\n"
+	             "  -d SECONDS   measured duration (default 10)\n"
+	             "  -w SECONDS   warmup, not measured (default 1)\n"
+	             "  -t SECONDS   a request without progress for this long is a timeout "
+	             "(default 5)\n"
+	             "  -C           close the connection after every request\n"
+	             "  -r REQUEST   \"METHOD /path [weight=N] [body=BYTES] [chunk=BYTES] "
+	             "[status=CODE]\"\n"
+	             "Exits with 3 if a response has another status than expected (status=, or "
+	             "2xx/3xx),\nor on connection errors and timeouts.\n",
+	             prog);
+}
+
+static unsigned long parseNumber(const std::string &value, const std::string &what) {
+	char *end;
+	errno = 0;
+	unsigned long n = std::strtoul(value.c_str(), &end, 10);
+	if (value.empty() || *end || errno)
+		throw std::runtime_error("invalid " + what + ": " + value);
+	return n;
+}
+
+static double parseSeconds(const char *value) {
+	char *end;
+	double s = std::strtod(value, &end);
+	if (*end || s < 0)
+		throw std::runtime_error(std::string("invalid duration: ") + value);
+	return s;
+}
+
+static RequestSpec parseRequest(const std::string &spec) {
+	std::istringstream in(spec);
+	RequestSpec req;
+	std::string word;
+
+	req.body = 0;
+	req.chunk = 0;
+	req.weight = 1;
+	req.status = 0;
+	if (!(in >> req.method >> req.path) || req.path[0] != '/')
+		throw std::runtime_error("invalid request: " + spec);
+	while (in >> word) {
+		size_t eq = word.find('=');
+		std::string key = word.substr(0, eq);
+		std::string value = (eq == std::string::npos) ? "" : word.substr(eq + 1);
+		if (key == "weight")
+			req.weight = parseNumber(value, "weight");
+		else if (key == "body")
+			req.body = parseNumber(value, "body size");
+		else if (key == "chunk")
+			req.chunk = parseNumber(value, "chunk size");
+		else if (key == "status")
+			req.status = parseNumber(value, "status");
+		else
+			throw std::runtime_error("unknown request option: " + word);
+	}
+	if (req.weight == 0)
+		throw std::runtime_error("weight must be positive: " + spec);
+	return req;
+}
+
+static void serialize(RequestSpec &req, const Options &opt) {
+	std::string &w = req.wire;
+	w = req.method + " " + req.path + " HTTP/1.1\r\nHost: " + opt.host + ":" +
+	    toString(opt.port) + "\r\nUser-Agent: webserv-loadgen\r\n";
+	if (!opt.keepalive)
+		w += "Connection: close\r\n";
+	if (req.body && req.chunk) {
+		w += "Content-Type: application/octet-stream\r\nTransfer-Encoding: chunked\r\n\r\n";
+		for (size_t sent = 0; sent < req.body; sent += req.chunk) {
+			size_t len = std::min(req.chunk, req.body - sent);
+			char size[32];
+			std::snprintf(size, sizeof(size), "%lx\r\n", static_cast<unsigned long>(len));
+			w += size;
+			w.append(len, 'x');
+			w += "\r\n";
+		}
+		w += "0\r\n\r\n";
+	} else if (req.body) {
+		w += "Content-Type: application/octet-stream\r\nContent-Length: " + toString(req.body) +
+		     "\r\n\r\n";
+		w.append(req.body, 'x');
+	} else
+		w += "\r\n";
+}
+
+static Options parseOptions(int argc, char **argv) {
+	Options opt;
+	int c;
+	while ((c = getopt(argc, argv, "n:H:p:c:P:d:w:t:Cr:")) != -1) {
+		switch (c) {
+		case 'n': opt.name = optarg; break;
+		case 'H': opt.host = optarg; break;
+		case 'p': opt.port = parseNumber(optarg, "port"); break;
+		case 'c': opt.connections = parseNumber(optarg, "connections"); break;
+		case 'P': opt.pipeline = parseNumber(optarg, "pipeline depth"); break;
+		case 'd': opt.duration = parseSeconds(optarg); break;
+		case 'w': opt.warmup = parseSeconds(optarg); break;
+		case 't': opt.timeout = parseSeconds(optarg); break;
+		case 'C': opt.keepalive = false; break;
+		case 'r': opt.mix.push_back(parseRequest(optarg)); break;
+		default: usage(argv[0]); std::exit(2);
+		}
+	}
+	if (opt.mix.empty() || opt.connections < 1 || opt.pipeline < 1) {
+		usage(argv[0]);
+		std::exit(2);
+	}
+	for (size_t i = 0; i < opt.mix.size(); ++i)
+		serialize(opt.mix[i], opt);
+	return opt;
+}
+
+class LoadGenerator {
+  public:
+	LoadGenerator(const Options &opt) : _opt(opt), _epoll(epoll_create1(0)), _turn(0) {
+		if (_epoll == -1)
+			throw std::runtime_error("epoll_create1 failed");
+		std::memset(&_addr, 0, sizeof(_addr));
+		_addr.sin_family = AF_INET;
+		_addr.sin_port = htons(opt.port);
+		if (inet_pton(AF_INET, opt.host.c_str(), &_addr.sin_addr) != 1)
+			throw std::runtime_error("invalid IPv4 address: " + opt.host);
+		// weighted round robin, expanded once: same sequence on every run
+		for (size_t i = 0; i < opt.mix.size(); ++i)
+			_order.insert(_order.end(), opt.mix[i].weight, i);
+		_clients.resize(opt.connections);
+	}
+
+	~LoadGenerator() {
+		for (size_t i = 0; i < _clients.size(); ++i)
+			if (_clients[i].fd != -1)
+				close(_clients[i].fd);
+		close(_epoll);
+	}
+
+	void run() {
+		long start = nowUs();
+		long measure_from = start + static_cast<long>(_opt.warmup * 1e6);
+		long end = measure_from + static_cast<long>(_opt.duration * 1e6);
+		struct epoll_event events[256];
+
+		for (size_t i = 0; i < _clients.size(); ++i)
+			connectClient(i);
+		_measuring = false;
+		for (long now = start; now < end; now = nowUs()) {
+			if (!_measuring && now >= measure_from) {
+				_measuring = true;
+				_stats = Stats();
+				_started = now;
+			}
+			int n = epoll_wait(_epoll, events, 256, 10);
+			for (int e = 0; e < n; ++e)
+				handleEvent(events[e].data.u32, events[e].events);
+			checkTimeouts(nowUs());
+		}
+		_elapsed = nowUs() - _started;
+	}
+
+	/// \returns True if every measured response had its expected status.
+	bool clean() const {
+		return !_stats.unexpected && !_stats.errors && !_stats.status[0] && !_stats.timeouts;
+	}
+
+	void report() const {
+		std::vector<long> lat = _stats.latencies;
+		std::sort(lat.begin(), lat.end());
+		double secs = _elapsed / 1e6;
+		double mean = 0;
+		for (size_t i = 0; i < lat.size(); ++i)
+			mean += lat[i];
+		if (!lat.empty())
+			mean /= lat.size();
+
+		std::printf("{\"scenario\":\"%s\",\"connections\":%d,\"pipeline\":%d,\"keepalive\":%s,"
+		            "\"duration_s\":%.3f,\"requests\":%lu,\"rps\":%.1f,",
+		            _opt.name.c_str(), _opt.connections, _opt.pipeline,
+		            _opt.keepalive ? "true" : "false", secs,
+		            static_cast<unsigned long>(lat.size()), secs > 0 ? lat.size() / secs : 0.0);
+		std::printf("\"latency_us\":{\"mean\":%.0f,\"p50\":%ld,\"p90\":%ld,\"p99\":%ld,"
+		            "\"p999\":%ld,\"max\":%ld},",
+		            mean, percentile(lat, 0.5), percentile(lat, 0.9), percentile(lat, 0.99),
+		            percentile(lat, 0.999), lat.empty() ? 0 : lat.back());
+		std::printf("\"status\":{\"1xx\":%lu,\"2xx\":%lu,\"3xx\":%lu,\"4xx\":%lu,\"5xx\":%lu},"
+		            "\"unexpected\":%lu,\"errors\":%lu,\"timeouts\":%lu,\"connects\":%lu,"
+		            "\"bytes_in\":%lu,\"bytes_out\":%lu}\n",
+		            _stats.status[1], _stats.status[2], _stats.status[3], _stats.status[4],
+		            _stats.status[5], _stats.unexpected, _stats.errors + _stats.status[0],
+		            _stats.timeouts,
+		            _stats.connects, _stats.bytes_in, _stats.bytes_out);
+	}
+
+  private:
+	const Options &_opt;
+	int _epoll;
+	struct sockaddr_in _addr;
+	std::vector<size_t> _order;
+	size_t _turn;
+	std::vector<Client> _clients;
+	Stats _stats;
+	bool _measuring;
+	long _started;
+	long _elapsed;
+
+	static long percentile(const std::vector<long> &sorted, double q) {
+		if (sorted.empty())
+			return 0;
+		size_t rank = static_cast<size_t>(q * sorted.size());
+		return sorted[std::min(rank, sorted.size() - 1)];
+	}
+
+	void connectClient(size_t i) {
+		Client &cl = _clients[i];
+		cl = Client();
+		cl.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+		if (cl.fd == -1)
+			throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+		int one = 1;
+		setsockopt(cl.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		if (connect(cl.fd, reinterpret_cast<struct sockaddr *>(&_addr), sizeof(_addr)) == -1 &&
+		    errno != EINPROGRESS) {
+			++_stats.errors;
+			close(cl.fd);
+			cl.fd = -1;
+			return;
+		}
+		++_stats.connects;
+		struct epoll_event ev;
+		ev.events = EPOLLIN | EPOLLOUT;
+		ev.data.u64 = 0;
+		ev.data.u32 = i;
+		epoll_ctl(_epoll, EPOLL_CTL_ADD, cl.fd, &ev);
+		cl.last_progress = nowUs();
+	}
+
+	// drops the connection; what it still waited for failed
+	void reconnect(size_t i, bool failed) {
+		Client &cl = _clients[i];
+		if (failed && _measuring)
+			_stats.errors += std::max<size_t>(cl.inflight.size(), 1);
+		epoll_ctl(_epoll, EPOLL_CTL_DEL, cl.fd, NULL);
+		close(cl.fd);
+		connectClient(i);
+	}
+
+	void fill(Client &cl, long now) {
+		if (cl.inflight.empty())
+			cl.last_progress = now; // idle until now, the timeout starts here
+		while (static_cast<int>(cl.inflight.size()) < _opt.pipeline) {
+			const RequestSpec &req = _opt.mix[_order[_turn]];
+			_turn = (_turn + 1) % _order.size();
+			if (cl.out_off == cl.out.size()) {
+				cl.out.clear();
+				cl.out_off = 0;
+			}
+			cl.out += req.wire;
+			InFlight f;
+			f.queued = now;
+			f.head = (req.method == "HEAD");
+			f.expect = req.status;
+			cl.inflight.push_back(f);
+			if (!_opt.keepalive)
+				break; // one request per connection
+		}
+	}
+
+	// sends what the socket takes, waiting for EPOLLOUT only while some is left
+	bool flush(size_t i) {
+		Client &cl = _clients[i];
+		bool blocked = false;
+		while (cl.out_off < cl.out.size()) {
+			ssize_t n = send(cl.fd, cl.out.data() + cl.out_off, cl.out.size() - cl.out_off,
+			                 MSG_NOSIGNAL);
+			if (n == -1) {
+				if (errno != EAGAIN && errno != EWOULDBLOCK)
+					return false;
+				blocked = true;
+				break;
+			}
+			cl.out_off += n;
+			if (_measuring)
+				_stats.bytes_out += n;
+		}
+		struct epoll_event ev;
+		ev.events = blocked ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+		ev.data.u64 = 0;
+		ev.data.u32 = i;
+		epoll_ctl(_epoll, EPOLL_CTL_MOD, cl.fd, &ev);
+		return true;
+	}
+
+	void handleEvent(size_t i, uint32_t mask) {
+		Client &cl = _clients[i];
+		long now = nowUs();
+		if (!cl.connected && (mask & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+			int err = 0;
+			socklen_t len = sizeof(err);
+			getsockopt(cl.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+			if (err) {
+				reconnect(i, true);
+				return;
+			}
+			cl.connected = true;
+			fill(cl, now);
+		}
+		if (mask & EPOLLIN) {
+			char buf[65536];
+			ssize_t n;
+			while ((n = recv(cl.fd, buf, sizeof(buf), 0)) > 0) {
+				cl.in.append(buf, n);
+				cl.last_progress = now;
+				if (_measuring)
+					_stats.bytes_in += n;
+			}
+			bool closed = (n == 0 || (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK));
+			bool reopen = false;
+			if (!parseResponses(cl, now, closed, reopen)) {
+				reconnect(i, true);
+				return;
+			}
+			if (closed || reopen) {
+				reconnect(i, !cl.inflight.empty());
+				return;
+			}
+			fill(cl, now);
+		}
+		if (cl.connected && !flush(i))
+			reconnect(i, true);
+	}
+
+	// Consumes the complete responses at the front of cl.in.
+	// \returns false on a malformed response.
+	bool parseResponses(Client &cl, long now, bool eof, bool &reopen) {
+		while (!cl.inflight.empty()) {
+			size_t head_end = cl.in.find("\r\n\r\n", cl.in_off);
+			if (head_end == std::string::npos)
+				break;
+			std::string head = cl.in.substr(cl.in_off, head_end - cl.in_off);
+			for (size_t k = 0; k < head.size(); ++k)
+				head[k] = std::tolower(static_cast<unsigned char>(head[k]));
+			if (head.compare(0, 5, "http/") != 0)
+				return false;
+			int code = std::atoi(head.c_str() + head.find(' ') + 1);
+			size_t body_start = head_end + 4;
+			size_t end;
+			if (cl.inflight.front().head || code == 204 || code == 304 || code < 200)
+				end = body_start;
+			else if (head.find("\r\ntransfer-encoding: chunked") != std::string::npos) {
+				if (!chunkedEnd(cl.in, body_start, end))
+					break;
+			} else {
+				size_t cl_pos = head.find("\r\ncontent-length:");
+				if (cl_pos != std::string::npos)
+					end = body_start + std::strtoul(head.c_str() + cl_pos + 17, NULL, 10);
+				else if (eof)
+					end = cl.in.size(); // delimited by close
+				else
+					break;
+			}
+			if (end > cl.in.size())
+				break;
+
+			InFlight done = cl.inflight.front();
+			cl.inflight.pop_front();
+			if (_measuring && done.queued >= _started) {
+				_stats.latencies.push_back(now - done.queued);
+				++_stats.status[(code >= 100 && code < 600) ? code / 100 : 0];
+				if (done.expect ? code != done.expect : (code < 200 || code >= 400))
+					++_stats.unexpected;
+			}
+			cl.in_off = end;
+			if (head.find("\r\nconnection: close") != std::string::npos || !_opt.keepalive)
+				reopen = true;
+		}
+		if (cl.in_off == cl.in.size()) {
+			cl.in.clear();
+			cl.in_off = 0;
+		}
+		return true;
+	}
+
+	// \returns false until the last chunk and the trailers are buffered
+	static bool chunkedEnd(const std::string &in, size_t pos, size_t &end) {
+		for (;;) {
+			size_t eol = in.find("\r\n", pos);
+			if (eol == std::string::npos)
+				return false;
+			unsigned long size = std::strtoul(in.c_str() + pos, NULL, 16);
+			if (size == 0) {
+				size_t trailers = in.find("\r\n\r\n", eol);
+				if (trailers == std::string::npos)
+					return false;
+				end = trailers + 4;
+				return true;
+			}
+			pos = eol + 2 + size + 2;
+			if (pos > in.size())
+				return false;
+		}
+	}
+
+	void checkTimeouts(long now) {
+		long limit = static_cast<long>(_opt.timeout * 1e6);
+		for (size_t i = 0; i < _clients.size(); ++i) {
+			Client &cl = _clients[i];
+			if (cl.fd == -1) {
+				connectClient(i);
+				continue;
+			}
+			if (now - cl.last_progress < limit || (cl.connected && cl.inflight.empty()))
+				continue;
+			if (_measuring)
+				_stats.timeouts += std::max<size_t>(cl.inflight.size(), 1);
+			reconnect(i, false);
+		}
+	}
+};
+
+int main(int argc, char **argv) {
+	signal(SIGPIPE, SIG_IGN);
+	try {
+		Options opt = parseOptions(argc, argv);
+		LoadGenerator gen(opt);
+		gen.run();
+		gen.report();
+		if (!gen.clean())
+			return 3;
+	} catch (const std::exception &e) {
+		std::fprintf(stderr, "loadgen: %s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,358 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   microbench.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 15:34:52 by jalombar          #+#    #+#             */
+/*   Updated: 2026/10/19 15:34:52 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Microbenchmarks of the request hot paths, linked against the server objects.
+//
+// Every benchmark replays a fixed, generated corpus: no randomness, no I/O.
+// The iteration count is calibrated once so a sample takes about -m
+// milliseconds, then -r samples are timed and the report gives the time per
+// operation of the fastest, median and slowest one. Compare medians between
+// runs of the same build on the same machine; a wide min..max means the
+// machine was busy. One JSON object per line.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "src/ConfigParser/Structs/LocationTrie.hpp"
+#include "src/HttpServer/Structs/ChunkedDecoder.hpp"
+#include "src/HttpServer/Structs/Response.hpp"
+#include "src/RequestParser/RequestParser.hpp"
+#include "src/Utils/ServerUtils.hpp"
+
+static volatile size_t g_sink; // results land here so nothing is optimized away
+
+static long nowNs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+class Bench {
+  public:
+	Bench(const char *name) : name(name), bytes(0) {}
+	virtual ~Bench() {}
+	/// Runs the corpus `n` times, returns the number of operations done.
+	virtual size_t run(size_t n) = 0;
+
+	const char *name;
+	size_t bytes; // input bytes per operation, 0 when it makes no sense
+};
+
+/* ---------------------------------------------------------------- corpora */
+
+static std::string smallGet() {
+	return "GET /static/css/site.min.css?v=42 HTTP/1.1\r\n"
+	       "Host: www.example.com\r\n"
+	       "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+	       "Accept: text/css,*/*;q=0.1\r\n"
+	       "Accept-Language: en-US,en;q=0.5\r\n"
+	       "Accept-Encoding: gzip, deflate, br\r\n"
+	       "Referer: https://www.example.com/index.html\r\n"
+	       "Connection: keep-alive\r\n"
+	       "\r\n";
+}
+
+static std::string manyHeaders(int count) {
+	std::string raw = "GET /api/v1/users/1234/orders?page=2&limit=50 HTTP/1.1\r\n"
+	                  "Host: api.example.com\r\n";
+	char line[128];
+	for (int i = 0; i < count - 1; ++i) {
+		std::snprintf(line, sizeof(line), "X-Custom-Header-%03d: value-%d-abcdefghijklmnopqrstuvwxyz\r\n",
+		              i, i * 7919);
+		raw += line;
+	}
+	return raw + "\r\n";
+}
+
+// `count` chunks cycling through first..last bytes, then the last chunk
+static std::string chunkedBody(int count, int first, int last) {
+	std::string body;
+	char size[32];
+	for (int i = 0; i < count; ++i) {
+		int n = first + i % (last - first + 1);
+		std::snprintf(size, sizeof(size), "%x\r\n", n);
+		body += size;
+		body.append(n, static_cast<char>('a' + i % 26));
+		body += "\r\n";
+	}
+	return body + "0\r\n\r\n";
+}
+
+/* ------------------------------------------------------------- benchmarks */
+
+class ParseHeaders : public Bench {
+  public:
+	ParseHeaders(const char *name, const std::string &raw) : Bench(name), _raw(raw), _lggr("", Logger::ERROR, false) {
+		bytes = raw.size();
+	}
+	size_t run(size_t n) {
+		for (size_t i = 0; i < n; ++i) {
+			ClientRequest req;
+			g_sink += RequestParsingUtils::parseRequestHeaders(_raw, req, _lggr) + req.headers.size();
+		}
+		return n;
+	}
+
+  private:
+	std::string _raw;
+	Logger _lggr;
+};
+
+class DecodeUri : public Bench {
+  public:
+	DecodeUri(const char *name, const char *const *uris) : Bench(name) {
+		for (; *uris; ++uris)
+			_uris.push_back(*uris);
+		for (size_t i = 0; i < _uris.size(); ++i)
+			bytes += _uris[i].size();
+		bytes /= _uris.size();
+	}
+	size_t run(size_t n) {
+		std::string decoded;
+		for (size_t i = 0; i < n; ++i)
+			for (size_t u = 0; u < _uris.size(); ++u)
+				g_sink += decodeNValidateUri(_uris[u], decoded) + decoded.size();
+		return n * _uris.size();
+	}
+
+  private:
+	std::vector<std::string> _uris;
+};
+
+// Location lookup of ServerConfig::findLocation, on a 40 location server
+class MatchLocation : public Bench {
+  public:
+	MatchLocation() : Bench("match_location") {
+		static const char *const locations[] = {
+		    "/", "/api/", "/api/v1/", "/api/v1/users/", "/api/v1/orders/", "/api/v2/",
+		    "/api/v2/users/", "/static/", "/static/css/", "/static/js/", "/static/img/",
+		    "/images/", "/uploads/", "/downloads/", "/docs/", "/docs/api/", "/blog/",
+		    "/blog/archive/", "/shop/", "/shop/cart/", "/shop/checkout/", "/account/",
+		    "/account/settings/", "/admin/", "/admin/users/", "/cgi-bin/", "/status",
+		    "/health", "/metrics", "/search", "/login", "/logout", "/register", "/about",
+		    "/contact", "/legal/", "/media/", "/media/video/", "/ws/", "/favicon.ico", NULL};
+		for (size_t i = 0; locations[i]; ++i)
+			_trie.insert(locations[i], i, std::strcmp(locations[i], "/favicon.ico") == 0);
+		static const char *const uris[] = {
+		    "/", "/index.html", "/api/v1/users/1234", "/api/v1/orders/98/items",
+		    "/api/v2/users/me", "/static/css/site.min.css", "/static/js/app.3f9a2c.js",
+		    "/static/img/logo.svg", "/images/2024/06/cover.jpg", "/docs/api/reference.html",
+		    "/blog/archive/2023/12/post-title", "/shop/checkout/confirm", "/account/settings/",
+		    "/statusx", "/favicon.ico", "/nothing/here/at/all", NULL};
+		for (size_t i = 0; uris[i]; ++i)
+			_uris.push_back(uris[i]);
+	}
+	size_t run(size_t n) {
+		for (size_t i = 0; i < n; ++i)
+			for (size_t u = 0; u < _uris.size(); ++u)
+				g_sink += _trie.match(_uris[u]);
+		return n * _uris.size();
+	}
+
+  private:
+	LocationTrie _trie;
+	std::vector<std::string> _uris;
+};
+
+/// Chunked decoding with the decoder of WebServer::decodeChunked, the body
+/// arriving in reads of `piece` bytes as processReceivedData appends them.
+class ChunkedDecode : public Bench {
+  public:
+	ChunkedDecode(const char *name, const std::string &body, size_t piece)
+	    : Bench(name), _body(body), _piece(piece) {
+		bytes = body.size();
+	}
+	size_t run(size_t n) {
+		for (size_t i = 0; i < n; ++i) {
+			ChunkedDecoder decoder;
+			std::string buf, out;
+			ChunkedDecoder::Result result = ChunkedDecoder::MORE;
+			for (size_t off = 0; off < _body.size() && result == ChunkedDecoder::MORE;
+			     off += _piece) {
+				buf.append(_body, off, _piece);
+				result = decoder.decode(buf, out, std::string::npos);
+			}
+			if (result != ChunkedDecoder::COMPLETE) {
+				std::fprintf(stderr, "%s: chunked body not decoded\n", name);
+				std::exit(1);
+			}
+			g_sink += out.size();
+		}
+		return n;
+	}
+
+  private:
+	std::string _body;
+	size_t _piece;
+};
+
+class Serialize : public Bench {
+  public:
+	Serialize(const char *name, size_t body, bool headers_only)
+	    : Bench(name), _response(200, std::string(body, 'x')), _headers_only(headers_only) {
+		_response.setContentType("text/html");
+		_response.setContentLength(body);
+		_response.setHeader("Date", "Mon, 19 Oct 2026 12:00:00 GMT");
+		_response.setHeader("Last-Modified", "Sun, 18 Oct 2026 08:30:00 GMT");
+		_response.setHeader("ETag", "\"65f2a1c0-400\"");
+		_response.setHeader("Cache-Control", "max-age=3600");
+		_response.setHeader("Accept-Ranges", "bytes");
+		_response.setHeader("Connection", "keep-alive");
+		_response.setHeader("Server", "webserv");
+		bytes = _response.toString().size();
+	}
+	size_t run(size_t n) {
+		for (size_t i = 0; i < n; ++i)
+			g_sink += (_headers_only ? _response.toStringHeadersOnly() : _response.toString()).size();
+		return n;
+	}
+
+  private:
+	Response _response;
+	bool _headers_only;
+};
+
+class ContentType : public Bench {
+  public:
+	ContentType() : Bench("detect_content_type") {
+		static const char *const paths[] = {
+		    "/var/www/index.html", "/var/www/static/css/site.min.css",
+		    "/var/www/static/js/app.3f9a2c.js", "/var/www/images/cover.JPG",
+		    "/var/www/images/logo.svg", "/var/www/fonts/inter.woff2", "/var/www/data/report.pdf",
+		    "/var/www/data/export.json", "/var/www/video/intro.mp4", "/var/www/archive.tar.gz",
+		    "/var/www/favicon.ico", "/var/www/README", "/var/www/notes.unknownext",
+		    "/var/www/.hidden", "/var/www/dir.d/file", "/var/www/feed.xml", NULL};
+		for (size_t i = 0; paths[i]; ++i)
+			_paths.push_back(paths[i]);
+	}
+	size_t run(size_t n) {
+		for (size_t i = 0; i < n; ++i)
+			for (size_t p = 0; p < _paths.size(); ++p)
+				g_sink += detectContentType(MimeTypes::builtin(), _paths[p]).size();
+		return n * _paths.size();
+	}
+
+  private:
+	std::vector<std::string> _paths;
+};
+
+/* ---------------------------------------------------------------- harness */
+
+static void usage(const char *prog) {
+	std::fprintf(stderr,
+	             "Usage: %s [-f FILTER] [-r SAMPLES] [-m MS] [-l]\n"
+	             "  -f FILTER    only benchmarks whose name contains FILTER\n"
+	             "  -r SAMPLES   timed samples per benchmark (default 9)\n"
+	             "  -m MS        target duration of one sample (default 50)\n"
+	             "  -l           list the benchmarks and exit\n",
+	             prog);
+}
+
+static void measure(Bench &bench, int samples, long sample_ns) {
+	// Calibration: double the iterations until a run is long enough
+	size_t n = 1;
+	for (;;) {
+		long start = nowNs();
+		bench.run(n);
+		long elapsed = nowNs() - start;
+		if (elapsed >= sample_ns / 4 || n >= (1UL << 30)) {
+			if (elapsed > 0)
+				n = std::max<size_t>(1, static_cast<size_t>(n * (static_cast<double>(sample_ns) / elapsed)));
+			break;
+		}
+		n *= 2;
+	}
+
+	std::vector<double> per_op;
+	size_t ops = 0;
+	for (int s = 0; s < samples; ++s) {
+		long start = nowNs();
+		ops = bench.run(n);
+		per_op.push_back(static_cast<double>(nowNs() - start) / ops);
+	}
+	std::sort(per_op.begin(), per_op.end());
+	double median = per_op[per_op.size() / 2];
+
+	std::printf("{\"bench\":\"%s\",\"ops_per_sample\":%lu,\"samples\":%d,"
+	            "\"ns_per_op\":{\"min\":%.1f,\"median\":%.1f,\"max\":%.1f}",
+	            bench.name, static_cast<unsigned long>(ops), samples, per_op.front(), median,
+	            per_op.back());
+	if (bench.bytes)
+		std::printf(",\"bytes_per_op\":%lu,\"mb_per_s\":%.1f", static_cast<unsigned long>(bench.bytes),
+		            bench.bytes / median * 1e9 / (1024 * 1024));
+	std::printf("}\n");
+	std::fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+	const char *filter = "";
+	int samples = 9;
+	long sample_ms = 50;
+	bool list = false;
+	int c;
+	while ((c = getopt(argc, argv, "f:r:m:l")) != -1) {
+		switch (c) {
+		case 'f': filter = optarg; break;
+		case 'r': samples = std::atoi(optarg); break;
+		case 'm': sample_ms = std::atol(optarg); break;
+		case 'l': list = true; break;
+		default: usage(argv[0]); return 2;
+		}
+	}
+	if (samples < 1 || sample_ms < 1) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	static const char *const plain[] = {"/index.html", "/static/css/site.min.css",
+	                                    "/api/v1/users/1234/orders", "/images/2024/06/cover.jpg",
+	                                    NULL};
+	static const char *const query[] = {"/search?q=hello%20world&lang=en&page=2",
+	                                    "/api/v1/items?filter=name%3Dfoo%26size%3D10&sort=-date",
+	                                    NULL};
+	static const char *const escaped[] = {
+	    "/files/%E6%97%A5%E6%9C%AC%E8%AA%9E/report%202024%20final.pdf",
+	    "/%7Euser/My%20Documents/%C3%A9t%C3%A9%20photos/IMG%5F0001.JPG", NULL};
+
+	std::vector<Bench *> benches;
+	benches.push_back(new ParseHeaders("parse_headers_small_get", smallGet()));
+	benches.push_back(new ParseHeaders("parse_headers_100", manyHeaders(100)));
+	benches.push_back(new DecodeUri("decode_uri_plain", plain));
+	benches.push_back(new DecodeUri("decode_uri_query", query));
+	benches.push_back(new DecodeUri("decode_uri_escaped", escaped));
+	benches.push_back(new MatchLocation());
+	benches.push_back(new ChunkedDecode("chunked_tiny_chunks", chunkedBody(2048, 1, 16), 12288));
+	benches.push_back(new ChunkedDecode("chunked_4k_chunks", chunkedBody(16, 4096, 4096), 12288));
+	benches.push_back(new ChunkedDecode("chunked_tiny_reads", chunkedBody(256, 1, 64), 256));
+	benches.push_back(new Serialize("response_to_string_1k", 1024, false));
+	benches.push_back(new Serialize("response_to_string_64k", 65536, false));
+	benches.push_back(new Serialize("response_headers_only", 0, true));
+	benches.push_back(new ContentType());
+
+	for (size_t i = 0; i < benches.size(); ++i) {
+		if (std::strstr(benches[i]->name, filter) == NULL)
+			continue;
+		if (list)
+			std::printf("%s\n", benches[i]->name);
+		else
+			measure(*benches[i], samples, sample_ms * 1000000L);
+	}
+	for (size_t i = 0; i < benches.size(); ++i)
+		delete benches[i];
+	return 0;
+}
@@ -0,0 +1,11 @@
+import os
+import sys
+
+# Reads the whole request body and reports its size, for the benchmarks
+body = sys.stdin.buffer.read()
+query = os.environ.get('QUERY_STRING', '')
+
+print("200")
+print()
+print("<html><body><p>%s %d bytes%s</p></body></html>" % (
+	os.environ.get('REQUEST_METHOD', 'GET'), len(body), (' ' + query) if query else ''))
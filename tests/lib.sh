@@ -0,0 +1,42 @@
+#!/bin/bash
+# helpers shared by the curl based test scripts, source it and end with finish
+
+# Colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m' # no color
+
+FAILED=0
+
+check() {
+  local name="$1"
+  local expected="$2"
+  local got="$3"
+
+  if [ "$expected" = "$got" ]; then
+    echo -e "${GREEN}[PASS]${NC} $name"
+  else
+    echo -e "${RED}[FAIL]${NC} $name (expected '$expected', got '$got')"
+    FAILED=$((FAILED + 1))
+  fi
+}
+
+# status [curl args] URL
+status() {
+  curl -s -o /dev/null -w '%{http_code}' "$@"
+}
+
+# header NAME [curl args] URL
+header() {
+  curl -s -o /dev/null -D - "${@:2}" | tr -d '\r' | grep -i "^$1:" | cut -d' ' -f2-
+}
+
+# exits 1 if any check failed
+finish() {
+  if [ $FAILED -ne 0 ]; then
+    echo -e "\n${RED}========== $FAILED TEST(S) FAILED ==========${NC}"
+    exit 1
+  fi
+  echo -e "\n${GREEN}========== TESTS COMPLETED ==========${NC}"
+}